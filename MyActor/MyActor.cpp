@@ -1,10 +1,12 @@
 #include <iostream>
 #include "./actor/my_actor.h"
 #include "./actor/actor_socket.h"
+#include "./actor/unix_socket.h"
 #include "./actor/async_timer.h"
 #include "./actor/msg_queue.h"
 #include "./actor/generator.h"
 #include "./actor/channel.h"
+#include "./actor/fork_join.h"
 #include "./actor/trace.h"
 
 void wait_multi_msg()
@@ -1011,6 +1013,1645 @@ void co_perfor_test()
 	trace_line("end co_perfor_test");
 }
 
+void co_bulk_go_perfor_test()
+{
+	trace_line("begin co_bulk_go_perfor_test");
+	io_engine ios;
+	ios.run(run_thread::cpu_thread_number());
+	std::vector<shared_strand> strands = boost_strand::create_multi(ios.ioThreads(), ios);
+	const size_t num = 1000000;
+	actor_handle ah = my_actor::create(boost_strand::create(ios), [&](my_actor* self)
+	{
+		{
+			std::atomic<size_t> count(num);
+			trig_once_notifer<> doneNtf;
+			long long tk = get_tick_us();
+			self->trig([&](trig_once_notifer<>&& ntf)
+			{
+				doneNtf = std::move(ntf);
+				for (size_t i = 0; i < num; i++)
+				{
+					co_go(strands[i % strands.size()], [&]
+					{
+						if (0 == --count)
+						{
+							doneNtf();
+						}
+					})[](co_generator)
+					{
+						co_no_context;
+
+						co_begin;
+						co_end;
+					};
+				}
+			});
+			trace_line("co_go generator number=", num, ", spawn+join time=", get_tick_us() - tk, "us");
+		}
+		{
+			generator_group_handle group;
+			long long tk = get_tick_us();
+			self->trig([&](trig_once_notifer<>&& ntf)
+			{
+				group = generator_group::create(strands, num, [](size_t i)
+				{
+					return [](co_generator)
+					{
+						co_no_context;
+
+						co_begin;
+						co_end;
+					};
+				});
+				group->append_listen(std::move(ntf));
+			});
+			trace_line("generator_group generator number=", num, ", spawn+join time=", get_tick_us() - tk, "us");
+		}
+	});
+	ah->run();
+	ah->outside_wait_quit();
+	ios.stop();
+	trace_line("end co_bulk_go_perfor_test");
+}
+
+void id_alloc_perfor_test()
+{
+	trace_line("begin id_alloc_perfor_test");
+	const size_t num = 1000000;
+	for (size_t threadNum = 1; threadNum <= 32; threadNum *= 2)
+	{
+		io_engine ios;
+		ios.run(threadNum);
+		std::vector<shared_strand> strands = boost_strand::create_multi(threadNum, ios);
+		actor_handle ah = my_actor::create(boost_strand::create(ios), [&](my_actor* self)
+		{
+			std::atomic<size_t> remain(threadNum);
+			trig_once_notifer<> doneNtf;
+			long long tk = get_tick_us();
+			self->trig([&](trig_once_notifer<>&& ntf)
+			{
+				doneNtf = std::move(ntf);
+				for (size_t i = 0; i < threadNum; i++)
+				{
+					strands[i]->post([&, i]
+					{
+						for (size_t j = 0; j < num / threadNum; j++)
+						{
+							co_go(strands[i])[](co_generator)
+							{
+								co_no_context;
+
+								co_begin;
+								co_end;
+							};
+						}
+						if (0 == --remain)
+						{
+							doneNtf();
+						}
+					});
+				}
+			});
+			long long ts = get_tick_us() - tk;
+			trace_line("thread number=", threadNum, ", generator number=", num, ", create rate=", (int)((double)num * 1000000 / ts), "/s");
+		});
+		ah->run();
+		ah->outside_wait_quit();
+		ios.stop();
+	}
+	trace_line("end id_alloc_perfor_test");
+}
+
+void fork_join_perfor_test()
+{
+	trace_line("begin fork_join_perfor_test");
+	io_engine ios;
+	ios.run(run_thread::cpu_thread_number());
+	const size_t num = 50000000;
+	const size_t sortNum = 10000000;
+	std::vector<int> sortSrc(sortNum);
+	for (size_t i = 0; i < sortNum; i++)
+	{
+		sortSrc[i] = (int)((i * 2654435761) % 1000000007);
+	}
+	auto mapFunc = [](size_t i)->long long
+	{
+		return (long long)((i * i) % 7);
+	};
+	actor_handle ah = my_actor::create(boost_strand::create(ios), [&](my_actor* self)
+	{
+		{
+			long long tk = get_tick_us();
+			long long sum = 0;
+			for (size_t i = 0; i < num; i++)
+			{
+				sum += mapFunc(i);
+			}
+			trace_line("single thread sum=", sum, ", time=", get_tick_us() - tk, "us");
+		}
+#ifdef _OPENMP
+		{
+			long long tk = get_tick_us();
+			long long sum = 0;
+#pragma omp parallel for reduction(+:sum)
+			for (long long i = 0; i < (long long)num; i++)
+			{
+				sum += mapFunc((size_t)i);
+			}
+			trace_line("openmp sum=", sum, ", time=", get_tick_us() - tk, "us");
+		}
+#endif
+		{
+			long long tk = get_tick_us();
+			long long sum = parallel_reduce(self, ios, 0, num, (long long)0, mapFunc, [](long long a, long long b)
+			{
+				return a + b;
+			}, 4096);
+			trace_line("parallel_reduce sum=", sum, ", time=", get_tick_us() - tk, "us");
+		}
+		{
+			std::vector<int> data = sortSrc;
+			long long tk = get_tick_us();
+			std::sort(data.begin(), data.end());
+			trace_line("single thread sort time=", get_tick_us() - tk, "us");
+		}
+#ifdef _OPENMP
+		{
+			std::vector<int> data = sortSrc;
+			long long tk = get_tick_us();
+			const size_t blocks = ios.ioThreads();
+#pragma omp parallel for
+			for (long long i = 0; i < (long long)blocks; i++)
+			{
+				std::sort(data.begin() + sortNum * i / blocks, data.begin() + sortNum * (i + 1) / blocks);
+			}
+			for (size_t step = 1; step < blocks; step *= 2)
+			{
+#pragma omp parallel for
+				for (long long i = 0; i < (long long)blocks; i += 2 * step)
+				{
+					if (i + step < blocks)
+					{
+						const size_t end = i + 2 * step < blocks ? i + 2 * step : blocks;
+						std::inplace_merge(data.begin() + sortNum * i / blocks, data.begin() + sortNum * (i + step) / blocks, data.begin() + sortNum * end / blocks);
+					}
+				}
+			}
+			trace_line("openmp sort time=", get_tick_us() - tk, "us");
+		}
+#endif
+		{
+			std::vector<int> data = sortSrc;
+			long long tk = get_tick_us();
+			const size_t blocks = ios.ioThreads();
+			parallel_for(self, ios, 0, blocks, [&](size_t i)
+			{
+				std::sort(data.begin() + sortNum * i / blocks, data.begin() + sortNum * (i + 1) / blocks);
+			});
+			for (size_t step = 1; step < blocks; step *= 2)
+			{
+				parallel_for(self, ios, 0, (blocks + 2 * step - 1) / (2 * step), [&](size_t j)
+				{
+					const size_t i = j * 2 * step;
+					if (i + step < blocks)
+					{
+						const size_t end = i + 2 * step < blocks ? i + 2 * step : blocks;
+						std::inplace_merge(data.begin() + sortNum * i / blocks, data.begin() + sortNum * (i + step) / blocks, data.begin() + sortNum * end / blocks);
+					}
+				});
+			}
+			assert(std::is_sorted(data.begin(), data.end()));
+			trace_line("parallel_for sort time=", get_tick_us() - tk, "us");
+		}
+		{
+			long long sum1 = 0, sum2 = 0;
+			parallel_invoke(self, ios, [&]
+			{
+				for (size_t i = 0; i < num / 2; i++)
+				{
+					sum1 += mapFunc(i);
+				}
+			}, [&]
+			{
+				for (size_t i = num / 2; i < num; i++)
+				{
+					sum2 += mapFunc(i);
+				}
+			});
+			trace_line("parallel_invoke sum=", sum1 + sum2);
+		}
+	});
+	ah->run();
+	ah->outside_wait_quit();
+	long long coSum = 0;
+	co_go(ios)[&](co_generator)
+	{
+		co_no_context;
+
+		co_begin;
+		co_parallel_reduce(coSum, co_ios, 0, num, (long long)0, mapFunc, [](long long a, long long b)
+		{
+			return a + b;
+		});
+		co_end;
+	};
+	ios.stop();
+	trace_line("generator parallel_reduce sum=", coSum);
+	trace_line("end fork_join_perfor_test");
+}
+
+void msg_pool_perfor_test()
+{
+	trace_line("begin msg_pool_perfor_test");
+	io_engine ios;
+	ios.run(1);
+	actor_handle ah = my_actor::create(boost_strand::create(ios), [](my_actor* self)
+	{
+		const int num = 100000;
+		{
+			child_handle ch = self->create_child([](my_actor* self)
+			{
+				self->sleep(0);
+			});
+			long long tk = get_tick_us();
+			for (int i = 0; i < num; i++)
+			{
+				self->connect_msg_notifer_to<int>(ch, false, true);
+				self->connect_msg_notifer_to<move_test>(ch, false, true);
+				self->connect_msg_notifer_to<int, int>(ch, false, true);
+				self->connect_msg_notifer_to<int, move_test>(ch, false, true);
+				self->connect_msg_notifer_to<move_test, move_test>(ch, false, true);
+				self->connect_msg_notifer_to<long long>(ch, false, true);
+			}
+			trace_line("connect/disconnect number=", 6 * num, ", time=", get_tick_us() - tk, "us");
+			self->child_run(ch);
+			self->child_wait_quit(ch);
+		}
+		{
+			long long tk = get_tick_us();
+			for (int i = 0; i < num; i++)
+			{
+				child_handle ch = self->create_child([](my_actor* self)
+				{
+					msg_pump_handle<int> pp = self->connect_msg_pump<int>();
+					self->pump_msg(pp);
+				});
+				self->child_run(ch);
+				auto ntf = self->connect_msg_notifer_to<int>(ch);
+				ntf(i);
+				self->child_wait_quit(ch);
+			}
+			trace_line("create+connect+first message number=", num, ", time=", get_tick_us() - tk, "us");
+		}
+	});
+	ah->run();
+	ah->outside_wait_quit();
+	ios.stop();
+	trace_line("end msg_pool_perfor_test");
+}
+
+void multicast_perfor_test()
+{
+	trace_line("begin multicast_perfor_test");
+	io_engine ios;
+	ios.run(run_thread::cpu_thread_number());
+	std::vector<shared_strand> strands = boost_strand::create_multi(ios.ioThreads(), ios);
+	const size_t actorNum = 2000;
+	const int eventNum = 100;
+	typedef std::shared_ptr<const std::string> payload;
+	actor_handle ah = my_actor::create(boost_strand::create(ios), [&](my_actor* self)
+	{
+		auto makeReceivers = [&](std::vector<actor_handle>& receivers)
+		{
+			for (size_t i = 0; i < actorNum; i++)
+			{
+				receivers.push_back(my_actor::create(strands[i % strands.size()], [eventNum](my_actor* self)
+				{
+					msg_pump_handle<payload> pump = self->connect_msg_pump<payload>();
+					for (int j = 0; j < eventNum; j++)
+					{
+						self->pump_msg(pump);
+					}
+				}));
+			}
+		};
+		const payload msg = std::make_shared<const std::string>(4096, 'x');
+		{
+			std::vector<actor_handle> receivers;
+			makeReceivers(receivers);
+			std::vector<post_actor_msg<payload>> ntfs;
+			for (size_t i = 0; i < receivers.size(); i++)
+			{
+				ntfs.push_back(self->connect_msg_notifer_to<payload>(receivers[i]));
+				receivers[i]->run();
+			}
+			long long tk = get_tick_us();
+			for (int j = 0; j < eventNum; j++)
+			{
+				for (size_t i = 0; i < ntfs.size(); i++)
+				{
+					ntfs[i](msg);
+				}
+			}
+			for (size_t i = 0; i < receivers.size(); i++)
+			{
+				self->actor_wait_quit(receivers[i]);
+			}
+			trace_line("post_actor_msg actor number=", actorNum, ", event number=", eventNum, ", time=", get_tick_us() - tk, "us");
+		}
+		{
+			std::vector<actor_handle> receivers;
+			makeReceivers(receivers);
+			multicast_actor_msg<payload> multicast;
+			for (size_t i = 0; i < receivers.size(); i++)
+			{
+				multicast.add(self->connect_msg_notifer_to<payload>(receivers[i]));
+				receivers[i]->run();
+			}
+			long long tk = get_tick_us();
+			for (int j = 0; j < eventNum; j++)
+			{
+				multicast(msg);
+			}
+			for (size_t i = 0; i < receivers.size(); i++)
+			{
+				self->actor_wait_quit(receivers[i]);
+			}
+			trace_line("multicast_actor_msg actor number=", actorNum, ", strand number=", multicast.strand_count(), ", event number=", eventNum, ", time=", get_tick_us() - tk, "us");
+		}
+	});
+	ah->run();
+	ah->outside_wait_quit();
+	ios.stop();
+	trace_line("end multicast_perfor_test");
+}
+
+void agent_chain_perfor_test()
+{
+	trace_line("begin agent_chain_perfor_test");
+	io_engine ios;
+	ios.run(run_thread::cpu_thread_number());
+	std::vector<shared_strand> strands = boost_strand::create_multi(ios.ioThreads(), ios);
+	const int msgNum = 100000;
+	const int depths[] = { 1, 4, 16, 32 };
+	for (int depth : depths)
+	{
+		actor_handle ah = my_actor::create(strands[0], [&](my_actor* self)
+		{
+			post_actor_msg<int> ack = self->connect_msg_notifer_to_self<int>();
+			msg_pump_handle<int> ackPump = self->connect_msg_pump<int>();
+			std::function<void(my_actor*, int)> agentLevel = [&](my_actor* self, int level)
+			{
+				if (level < depth)
+				{
+					child_handle ch = self->create_child(strands[(level + 1) % strands.size()], [&agentLevel, level](my_actor* self)
+					{
+						agentLevel(self, level + 1);
+					});
+					self->child_run(ch);
+					self->msg_agent_to<int>(ch);
+					self->child_wait_quit(ch);
+				}
+				else
+				{
+					msg_pump_handle<int> pump = self->connect_msg_pump<int>();
+					while (true)
+					{
+						int i = self->pump_msg(pump);
+						if (i < 0)
+						{
+							break;
+						}
+						ack(i);
+					}
+				}
+			};
+			child_handle head = self->create_child(strands[1 % strands.size()], [&agentLevel](my_actor* self)
+			{
+				agentLevel(self, 0);
+			});
+			self->child_run(head);
+			post_actor_msg<int> ntf = self->connect_msg_notifer_to<int>(head);
+			long long tk = get_tick_us();
+			for (int i = 0; i < msgNum; i++)
+			{
+				ntf(i);
+				self->pump_msg(ackPump);
+			}
+			tk = get_tick_us() - tk;
+			ntf(-1);
+			self->child_wait_quit(head);
+			trace_line("agent depth=", depth, ", message number=", msgNum, ", round trip=", (double)tk / msgNum, "us");
+		});
+		ah->run();
+		ah->outside_wait_quit();
+	}
+	ios.stop();
+	trace_line("end agent_chain_perfor_test");
+}
+
+void mailbox_lane_perfor_test()
+{
+	trace_line("begin mailbox_lane_perfor_test");
+	io_engine ios;
+	ios.run(2);
+	const int dataNum = 200000;
+	for (int lanes = 1; lanes <= msg_lane::count; lanes += msg_lane::count - 1)
+	{
+		actor_handle ah = my_actor::create(boost_strand::create(ios), [&](my_actor* self)
+		{
+			post_actor_msg<> ready = self->connect_msg_notifer_to_self<>();
+			msg_pump_handle<> readyPump = self->connect_msg_pump<>();
+			long long controlTick = 0;
+			int dataBefore = 0;
+			child_handle ch = self->create_child(boost_strand::create(ios), [&](my_actor* self)
+			{
+				msg_pump_handle<int, long long> pump = self->connect_msg_pump<int, long long>();
+				self->msg_pump_lanes(pump, lanes);
+				ready();
+				int dataCount = 0;
+				while (true)
+				{
+					int kind = 0;
+					long long tick = 0;
+					self->pump_msg(pump, kind, tick);
+					if (0 == kind)
+					{
+						if (dataNum == ++dataCount)
+						{
+							break;
+						}
+					}
+					else
+					{
+						controlTick = get_tick_us() - tick;
+						dataBefore = dataCount;
+					}
+				}
+			});
+			self->child_run(ch);
+			self->pump_msg(readyPump);
+			post_actor_msg<int, long long> ntf = self->connect_msg_notifer_to<int, long long>(ch);
+			for (int i = 0; i < dataNum; i++)
+			{
+				ntf(0, 0);
+			}
+			ntf.post_lane(msg_lane::high, 1, get_tick_us());
+			self->child_wait_quit(ch);
+			trace_line("lane number=", lanes, ", queued data=", dataNum, ", data before control=", dataBefore, ", control latency=", controlTick, "us");
+		});
+		ah->run();
+		ah->outside_wait_quit();
+	}
+	ios.stop();
+	trace_line("end mailbox_lane_perfor_test");
+}
+
+void ask_perfor_test()
+{
+	trace_line("begin ask_perfor_test");
+	io_engine ios;
+	ios.run(2);
+	const int askNum = 20000;
+	actor_handle ah = my_actor::create(boost_strand::create(ios), [&](my_actor* self)
+	{
+		child_handle trigServer = self->create_child(boost_strand::create(ios), [](my_actor* self)
+		{
+			msg_pump_handle<int, trig_notifer<int>> pump = self->connect_msg_pump<int, trig_notifer<int>>();
+			while (true)
+			{
+				int i = 0;
+				trig_notifer<int> ntf;
+				self->pump_msg(pump, i, ntf);
+				if (i < 0)
+				{
+					break;
+				}
+				ntf(i * 2);
+			}
+		});
+		child_handle askServer = self->create_child(boost_strand::create(ios), [](my_actor* self)
+		{
+			msg_pump_handle<int, ask_reply<int>> pump = self->connect_msg_pump<int, ask_reply<int>>();
+			while (true)
+			{
+				int i = 0;
+				ask_reply<int> reply;
+				self->pump_msg(pump, i, reply);
+				if (i < 0)
+				{
+					break;
+				}
+				reply(i * 2);
+			}
+		});
+		self->child_run(trigServer);
+		self->child_run(askServer);
+		post_actor_msg<int, trig_notifer<int>> trigNtf = self->connect_msg_notifer_to<int, trig_notifer<int>>(trigServer);
+		post_actor_msg<int, ask_reply<int>> askNtf = self->connect_msg_notifer_to<int, ask_reply<int>>(askServer);
+		{
+			long long tk = get_tick_us();
+			std::unique_ptr<trig_handle<int>[]> ths(new trig_handle<int>[askNum]);
+			for (int i = 0; i < askNum; i++)
+			{
+				trigNtf(i, self->make_trig_notifer_to_self(ths[i]));
+			}
+			long long sum = 0;
+			for (int i = 0; i < askNum; i++)
+			{
+				int r = 0;
+				if (self->timed_wait_trig(1000, ths[i], r))
+				{
+					sum += r;
+				}
+			}
+			trace_line("trig_handle ask number=", askNum, ", sum=", sum, ", time=", get_tick_us() - tk, "us");
+		}
+		{
+			long long tk = get_tick_us();
+			ask_box<int> box;
+			std::vector<ask_future<int>> futures;
+			futures.reserve(askNum);
+			for (int i = 0; i < askNum; i++)
+			{
+				futures.push_back(self->ask(box, 1000, [&](ask_reply<int>&& reply)
+				{
+					askNtf(i, std::move(reply));
+				}));
+			}
+			self->ask_wait_all(box);
+			long long sum = 0;
+			for (int i = 0; i < askNum; i++)
+			{
+				int r = 0;
+				if (box.take(futures[i], r))
+				{
+					sum += r;
+				}
+			}
+			trace_line("ask_wait_all ask number=", askNum, ", sum=", sum, ", time=", get_tick_us() - tk, "us");
+		}
+		{
+			long long tk = get_tick_us();
+			ask_box<int> box;
+			for (int i = 0; i < askNum; i++)
+			{
+				self->ask(box, 1000, [&](ask_reply<int>&& reply)
+				{
+					askNtf(i, std::move(reply));
+				});
+			}
+			long long sum = 0;
+			ask_future<int> f;
+			while (self->ask_wait_any(box, f))
+			{
+				int r = 0;
+				if (box.take(f, r))
+				{
+					sum += r;
+				}
+			}
+			trace_line("ask_wait_any ask number=", askNum, ", sum=", sum, ", time=", get_tick_us() - tk, "us");
+		}
+		trigNtf(-1, trig_notifer<int>());
+		askNtf(-1, ask_reply<int>());
+		self->child_wait_quit(trigServer);
+		self->child_wait_quit(askServer);
+	});
+	ah->run();
+	ah->outside_wait_quit();
+	ios.stop();
+	trace_line("end ask_perfor_test");
+}
+
+void check_lost_perfor_test()
+{
+	trace_line("begin check_lost_perfor_test");
+	io_engine ios;
+	ios.run(1);
+	const int ntfNum = 1000000;
+	actor_handle ah = my_actor::create(boost_strand::create(ios), [&](my_actor* self)
+	{
+		//off为不检测，on为当前编译模式下检测；lite模式用 make CONFIG=RELEASE_LITE 编译后对比
+#ifdef ENABLE_LITE_CHECK_LOST
+		const char* mode = "on(lite)";
+#elif (defined ENABLE_CHECK_LOST)
+		const char* mode = "on(shared_ptr)";
+#else
+		const char* mode = "on";
+#endif
+		auto test = [&](bool checkLost)
+		{
+			trig_handle<int> th;
+			long long tk = get_tick_us();
+			for (int i = 0; i < ntfNum; i++)
+			{
+				trig_notifer<int> ntf = self->make_trig_notifer_to_self(th, checkLost);
+				trig_notifer<int> ntf1 = ntf;
+				trig_notifer<int> ntf2 = std::move(ntf1);
+				ntf1 = ntf2;
+				self->close_trig_notifer(th);
+			}
+			trace_line("check lost=", checkLost ? mode : "off", ", notifer number=", ntfNum, ", time=", get_tick_us() - tk, "us");
+		};
+		test(false);
+#ifdef ENABLE_CHECK_LOST
+		test(true);
+#endif
+	});
+	ah->run();
+	ah->outside_wait_quit();
+	ios.stop();
+	trace_line("end check_lost_perfor_test");
+}
+
+void quit_notify_perfor_test()
+{
+	trace_line("begin quit_notify_perfor_test");
+	io_engine ios;
+	ios.run(1);
+	const int num = 100000;
+	actor_handle ah = my_actor::create(boost_strand::create(ios), [&](my_actor* self)
+	{
+		int notifyCount = 0;
+		long long tk = get_tick_us();
+		for (int i = 0; i < num; i++)
+		{
+			actor_handle child = my_actor::create(self->self_strand(), [](my_actor* self)
+			{
+				self->sleep(1000000);
+			});
+			child->append_quit_notify([&notifyCount, i, self]
+			{
+				notifyCount += 1 & i;
+			});
+			child->run();
+			self->actor_force_quit(child);
+		}
+		trace_line("actor create->quit number=", num, ", notify count=", notifyCount, ", time=", get_tick_us() - tk, "us");
+	});
+	ah->run();
+	ah->outside_wait_quit();
+	ios.stop();
+	trace_line("end quit_notify_perfor_test");
+}
+
+void mass_force_quit_perfor_test()
+{
+	trace_line("begin mass_force_quit_perfor_test");
+	io_engine ios;
+	ios.run(1);
+	const int num = 100000;
+	actor_handle ah = my_actor::create(boost_strand::create(ios), [&](my_actor* self)
+	{
+		for (int status = 0; status < 2; status++)
+		{
+			int quitCount = 0;
+			std::list<actor_handle> actors;
+			for (int i = 0; i < num; i++)
+			{
+				actor_handle child = my_actor::create(self->self_strand(), [&quitCount, status](my_actor* self)
+				{
+					self->enable_quit_status(0 != status);
+					while (!self->quit_status())
+					{
+						self->sleep(1000000);
+					}
+					quitCount++;
+				});
+				child->run();
+				actors.push_back(std::move(child));
+			}
+			self->sleep(100);
+			long long tk = get_tick_us();
+			self->actors_force_quit(actors);
+			trace_line(status ? "quit status" : "quit exception", " number=", num, ", return count=", quitCount, ", time=", get_tick_us() - tk, "us");
+		}
+	});
+	ah->run();
+	ah->outside_wait_quit();
+	ios.stop();
+	trace_line("end mass_force_quit_perfor_test");
+}
+
+void shard_accept_perfor_test()
+{
+	trace_line("begin shard_accept_perfor_test");
+	io_engine ios;
+	ios.run(4);
+	const int clientNum = 32;
+	const int connNum = 500;
+	actor_handle ah = my_actor::create(boost_strand::create(ios), [&](my_actor* self)
+	{
+		const size_t shardsList[] = { 1, 0 };
+		for (size_t shards : shardsList)
+		{
+			std::atomic<int> acceptCount(0);
+			tcp_shard_acceptor acc(ios);
+			tcp_socket::result res = acc.open("127.0.0.1", 1236, [&acceptCount](const shared_strand&, std::shared_ptr<tcp_socket>&& socket)
+			{
+				acceptCount++;
+				socket->close();
+			}, shards);
+			if (!res.ok)
+			{
+				trace_line("server port conflict");
+				return;
+			}
+			long long tk = get_tick_us();
+			std::list<actor_handle> clients;
+			for (int i = 0; i < clientNum; i++)
+			{
+				clients.push_back(my_actor::create(boost_strand::create(ios), [&](my_actor* self)
+				{
+					for (int j = 0; j < connNum; j++)
+					{
+						tcp_socket sck(self->self_io_engine());
+						sck.connect(self, "127.0.0.1", 1236);
+						sck.close();
+					}
+				}));
+				clients.back()->run();
+			}
+			self->actors_wait_quit(clients);
+			while (acceptCount < clientNum * connNum && get_tick_us() - tk < 10000000)
+			{
+				self->sleep(1);
+			}
+			trace_line("shards=", acc.shards(), ", connect number=", clientNum * connNum, ", accept count=", (int)acceptCount, ", time=", get_tick_us() - tk, "us");
+			acc.close(self);
+		}
+	});
+	ah->run();
+	ah->outside_wait_quit();
+	ios.stop();
+	trace_line("end shard_accept_perfor_test");
+}
+
+void socket_writev_perfor_test()
+{
+	trace_line("begin socket_writev_perfor_test");
+	io_engine ios;
+	ios.run(2);
+	const int num = 200000;
+	actor_handle ah = my_actor::create(boost_strand::create(ios), [&](my_actor* self)
+	{
+		char head[16];
+		std::shared_ptr<const std::string> body(new std::string(1024, 'b'));
+		memset(head, 'h', sizeof(head));
+		for (int mode = 0; mode < 3; mode++)
+		{
+			tcp_acceptor acc(self->self_io_engine());
+			if (!acc.open("127.0.0.1", 1237).ok)
+			{
+				trace_line("server port conflict");
+				return;
+			}
+			long long readBytes = 0;
+			child_handle srv = self->create_child(boost_strand::create(ios), [&](my_actor* self)
+			{
+				tcp_socket sck(self->self_io_engine());
+				if (acc.accept(self, sck).ok)
+				{
+					std::vector<char> buf(64 * 1024);
+					tcp_socket::result res;
+					while ((res = sck.read_some(self, &buf[0], buf.size())).ok)
+					{
+						readBytes += res.s;
+					}
+				}
+				sck.close();
+			});
+			self->child_run(srv);
+			tcp_socket sck(self->self_io_engine());
+			const bool connected = sck.connect(self, "127.0.0.1", 1237).ok;
+			if (connected)
+			{
+				long long tk = get_tick_us();
+				if (0 == mode)
+				{
+					std::vector<char> buf(sizeof(head) + body->size());
+					for (int i = 0; i < num; i++)
+					{
+						memcpy(&buf[0], head, sizeof(head));
+						memcpy(&buf[sizeof(head)], body->data(), body->size());
+						sck.write(self, &buf[0], buf.size());
+					}
+				}
+				else if (1 == mode)
+				{
+					for (int i = 0; i < num; i++)
+					{
+						const boost::asio::const_buffer buffs[2] = { boost::asio::buffer(head, sizeof(head)), boost::asio::buffer(body->data(), body->size()) };
+						sck.writev(self, buffs, 2);
+					}
+				}
+				else
+				{
+					for (int i = 0; i < num; i++)
+					{
+						buffer_chain chain;
+						chain.append(head, sizeof(head));
+						chain.append(body);
+						sck.write(self, chain);
+					}
+				}
+				trace_line(0 == mode ? "memcpy+write" : (1 == mode ? "writev" : "buffer_chain"), " number=", num, ", time=", get_tick_us() - tk, "us");
+			}
+			sck.close();
+			acc.close();
+			self->child_wait_quit(srv);
+			if (connected)
+			{
+				trace_line("read bytes=", readBytes);
+				assert((long long)num * (long long)(sizeof(head) + body->size()) == readBytes);
+			}
+		}
+	});
+	ah->run();
+	ah->outside_wait_quit();
+	ios.stop();
+	trace_line("end socket_writev_perfor_test");
+}
+
+void frame_reader_perfor_test()
+{
+	trace_line("begin frame_reader_perfor_test");
+	io_engine ios;
+	ios.run(2);
+	const int num = 500000;
+	const int batch = 1000;
+	const size_t payload = 32;
+	actor_handle ah = my_actor::create(boost_strand::create(ios), [&](my_actor* self)
+	{
+		for (int mode = 0; mode < 2; mode++)
+		{
+			tcp_acceptor acc(self->self_io_engine());
+			if (!acc.open("127.0.0.1", 1238).ok)
+			{
+				trace_line("server port conflict");
+				return;
+			}
+			child_handle srv = self->create_child(boost_strand::create(ios), [&](my_actor* self)
+			{
+				tcp_socket sck(self->self_io_engine());
+				if (acc.accept(self, sck).ok)
+				{
+					std::vector<char> buf(batch * (4 + payload), 'p');
+					for (int i = 0; i < batch; i++)
+					{
+						char* head = &buf[i * (4 + payload)];
+						head[0] = head[1] = head[2] = 0;
+						head[3] = (char)payload;
+					}
+					for (int i = 0; i < num; i += batch)
+					{
+						if (!sck.write(self, &buf[0], buf.size()).ok)
+						{
+							break;
+						}
+					}
+				}
+				sck.close();
+			});
+			self->child_run(srv);
+			tcp_socket sck(self->self_io_engine());
+			if (sck.connect(self, "127.0.0.1", 1238).ok)
+			{
+				int frames = 0;
+				size_t reads = 0;
+				long long tk = get_tick_us();
+				if (0 == mode)
+				{
+					char buf[256];
+					while (frames < num)
+					{
+						unsigned char head[4];
+						if (!sck.read(self, head, 4).ok)
+						{
+							break;
+						}
+						const size_t length = ((size_t)head[0] << 24) | ((size_t)head[1] << 16) | ((size_t)head[2] << 8) | head[3];
+						if (!sck.read(self, buf, length).ok)
+						{
+							break;
+						}
+						frames++;
+						reads += 2;
+					}
+				}
+				else
+				{
+					tcp_frame_reader reader(sck);
+					const char* frame = NULL;
+					size_t length = 0;
+					while (frames < num && reader.read_frame(self, frame, length).ok)
+					{
+						frames++;
+					}
+					reads = reader.read_count();
+				}
+				trace_line(0 == mode ? "read+read" : "tcp_frame_reader", " frames=", frames, ", read calls=", reads, ", time=", get_tick_us() - tk, "us");
+			}
+			sck.close();
+			acc.close();
+			self->child_wait_quit(srv);
+		}
+	});
+	ah->run();
+	ah->outside_wait_quit();
+	ios.stop();
+	trace_line("end frame_reader_perfor_test");
+}
+
+void zero_copy_perfor_test()
+{
+	trace_line("begin zero_copy_perfor_test");
+	io_engine ios;
+	ios.run(2);
+	const size_t totalBytes = 256 * 1024 * 1024;
+	actor_handle ah = my_actor::create(boost_strand::create(ios), [&](my_actor* self)
+	{
+		std::vector<char> payload(16 * 1024 * 1024, 'z');
+		for (size_t length = 64 * 1024; length <= payload.size(); length *= 4)
+		{
+			for (int mode = 0; mode < 2; mode++)
+			{
+				tcp_acceptor acc(self->self_io_engine());
+				if (!acc.open("127.0.0.1", 1239).ok)
+				{
+					trace_line("server port conflict");
+					return;
+				}
+				child_handle srv = self->create_child(boost_strand::create(ios), [&](my_actor* self)
+				{
+					tcp_socket sck(self->self_io_engine());
+					if (acc.accept(self, sck).ok)
+					{
+						std::vector<char> buf(1024 * 1024);
+						while (sck.read_some(self, &buf[0], buf.size()).ok) {}
+					}
+					sck.close();
+				});
+				self->child_run(srv);
+				tcp_socket sck(self->self_io_engine());
+				if (sck.connect(self, "127.0.0.1", 1239).ok)
+				{
+					if (mode && !sck.zero_copy().ok)
+					{
+						trace_line("MSG_ZEROCOPY not supported");
+					}
+					long long tk = get_tick_us();
+					for (size_t sent = 0; sent < totalBytes; sent += length)
+					{
+						if (!(mode ? sck.zero_copy_write(self, &payload[0], length) : sck.write(self, &payload[0], length)).ok)
+						{
+							break;
+						}
+					}
+					trace_line(mode ? "zero_copy_write" : "write", " payload=", length / 1024, "KB, total=", totalBytes / (1024 * 1024), "MB, time=", get_tick_us() - tk, "us");
+				}
+				sck.close();
+				acc.close();
+				self->child_wait_quit(srv);
+			}
+		}
+	});
+	ah->run();
+	ah->outside_wait_quit();
+	ios.stop();
+	trace_line("end zero_copy_perfor_test");
+}
+
+void udp_gso_perfor_test()
+{
+	trace_line("begin udp_gso_perfor_test");
+	io_engine ios;
+	ios.run(2);
+	const size_t total = 200000;
+	const size_t batch = 64;
+	const size_t length = 1200;
+	actor_handle ah = my_actor::create(boost_strand::create(ios), [&](my_actor* self)
+	{
+		for (int mode = 0; mode < 2; mode++)
+		{
+			udp_socket rudp(self->self_io_engine());
+			if (!rudp.open_bind_v4(1240).ok)
+			{
+				trace_line("server port conflict");
+				return;
+			}
+			if (mode && !rudp.gro().ok)
+			{
+				trace_line("UDP_GRO not supported");
+			}
+			child_handle receiver = self->create_child(boost_strand::create(ios), [&](my_actor* self)
+			{
+				std::vector<char> buf(batch * length);
+				void* buffs[batch];
+				size_t lengths[batch];
+				for (size_t i = 0; i < batch; i++)
+				{
+					buffs[i] = &buf[i * length];
+					lengths[i] = length;
+				}
+				size_t count = 0;
+				long long tk = get_tick_us();
+				//GRO合并的报文须经try_mreceive拆分，这里只窥探等待可读
+				while (rudp.timed_receive(self, 500, buffs[0], 0, MSG_PEEK).ok)
+				{
+					udp_socket::result res = rudp.try_mreceive(buffs, lengths, batch);
+					count += res.ok ? res.s : 0;
+				}
+				trace_line(mode ? "gro receive" : "receive", " count=", count, "/", total, ", time=", get_tick_us() - tk - 500000, "us");
+			});
+			self->child_run(receiver);
+			udp_socket sudp(self->self_io_engine());
+			sudp.open_v4();
+			sudp.connect("127.0.0.1", 1240);
+			if (mode && !sudp.gso().ok)
+			{
+				trace_line("UDP_SEGMENT not supported");
+			}
+			std::vector<char> payload(length, 'u');
+			const void* buffs[batch];
+			size_t lengths[batch];
+			for (size_t i = 0; i < batch; i++)
+			{
+				buffs[i] = &payload[0];
+				lengths[i] = length;
+			}
+			long long tk = get_tick_us();
+			for (size_t sent = 0; sent < total;)
+			{
+				udp_socket::result res = sudp.try_msend(buffs, lengths, batch);
+				if (res.ok)
+				{
+					sent += res.s;
+				}
+				else if (udp_socket::try_again(res))
+				{
+					self->yield();
+				}
+				else
+				{
+					break;
+				}
+			}
+			trace_line(mode ? "gso send" : "send", " count=", total, ", length=", length, ", time=", get_tick_us() - tk, "us");
+			self->child_wait_quit(receiver);
+			sudp.close();
+			rudp.close();
+		}
+	});
+	ah->run();
+	ah->outside_wait_quit();
+	ios.stop();
+	trace_line("end udp_gso_perfor_test");
+}
+
+void cork_write_perfor_test()
+{
+	trace_line("begin cork_write_perfor_test");
+	io_engine ios;
+	ios.run(2);
+	const size_t rounds = 20000;
+	const size_t batch = 16;
+	const size_t length = 100;
+	actor_handle ah = my_actor::create(boost_strand::create(ios), [&](my_actor* self)
+	{
+		for (int mode = 0; mode < 2; mode++)
+		{
+			tcp_acceptor acc(self->self_io_engine());
+			if (!acc.open("127.0.0.1", 1244).ok)
+			{
+				trace_line("server port conflict");
+				return;
+			}
+			size_t writeCount = 0;
+			child_handle srv = self->create_child(boost_strand::create(ios), [&](my_actor* self)
+			{
+				tcp_socket sck(self->self_io_engine());
+				if (acc.accept(self, sck).ok)
+				{
+					sck.no_delay();
+					tcp_cork_writer cork(self->self_strand(), sck);
+					char req[batch * length];
+					char res[length];
+					memset(res, 'r', sizeof(res));
+					//每个请求单独回复，合并模式下同一批回复在本次调度结束后一次写出
+					while (sck.read(self, req, sizeof(req)).ok)
+					{
+						bool ok = true;
+						for (size_t i = 0; i < batch && ok; i++)
+						{
+							if (mode)
+							{
+								ok = cork.write(self, res, sizeof(res)).ok;
+							}
+							else
+							{
+								ok = sck.write(self, res, sizeof(res)).ok;
+								writeCount++;
+							}
+						}
+						if (!ok)
+						{
+							break;
+						}
+					}
+					cork.flush(self);
+					if (mode)
+					{
+						writeCount = cork.write_count();
+					}
+				}
+				sck.close();
+			});
+			self->child_run(srv);
+			tcp_socket sck(self->self_io_engine());
+			if (sck.connect(self, "127.0.0.1", 1244).ok)
+			{
+				sck.no_delay();
+				char req[batch * length];
+				char res[batch * length];
+				memset(req, 'q', sizeof(req));
+				long long tk = get_tick_us();
+				for (size_t i = 0; i < rounds; i++)
+				{
+					if (!sck.write(self, req, sizeof(req)).ok || !sck.read(self, res, sizeof(res)).ok)
+					{
+						break;
+					}
+				}
+				long long tm = get_tick_us() - tk;
+				sck.close();
+				self->child_wait_quit(srv);
+				trace_line(mode ? "cork write" : "plain write", " rounds=", rounds, ", messages=", rounds * batch, ", write calls=", writeCount, ", time=", tm, "us");
+			}
+			else
+			{
+				sck.close();
+				self->child_wait_quit(srv);
+			}
+			acc.close();
+		}
+	});
+	ah->run();
+	ah->outside_wait_quit();
+	ios.stop();
+	trace_line("end cork_write_perfor_test");
+}
+
+void deadline_list_perfor_test()
+{
+	trace_line("begin deadline_list_perfor_test");
+	io_engine ios;
+	ios.run(2);
+	const size_t rounds = 100000;
+	actor_handle ah = my_actor::create(boost_strand::create(ios), [&](my_actor* self)
+	{
+		for (int mode = 0; mode < 2; mode++)
+		{
+			tcp_acceptor acc(self->self_io_engine());
+			if (!acc.open("127.0.0.1", 1245).ok)
+			{
+				trace_line("server port conflict");
+				return;
+			}
+			child_handle srv = self->create_child(boost_strand::create(ios), [&](my_actor* self)
+			{
+				socket_deadline_list deadlines(self->self_strand());
+				tcp_socket sck(self->self_io_engine());
+				if (acc.accept(self, sck).ok)
+				{
+					if (mode)
+					{
+						sck.set_deadline_list(&deadlines);
+					}
+					char buf[16];
+					size_t count = 0;
+					long long tk = get_tick_us();
+					tcp_socket::result res;
+					//长连接下每次等待请求都带超时，数据都在超时前到达
+					while (count < rounds && (res = sck.timed_read_some(self, 5000, buf, sizeof(buf))).ok)
+					{
+						if (!sck.timed_write(self, 5000, buf, res.s).ok)
+						{
+							break;
+						}
+						count++;
+					}
+					long long tm = get_tick_us() - tk;
+					trace_line(mode ? "deadline list" : "actor timer", " requests=", count, ", time=", tm, "us");
+					//客户端不再发送，检验超时
+					if (rounds == count)
+					{
+						tk = get_tick_us();
+						res = sck.timed_read_some(self, 300, buf, sizeof(buf));
+						trace_line("idle read ", res.code == boost::asio::error::timed_out ? "timed out" : "not timed out", " after ", (get_tick_us() - tk) / 1000, "ms, expired=", deadlines.expired_count());
+					}
+				}
+				sck.close();
+				sck.set_deadline_list(NULL);
+			});
+			self->child_run(srv);
+			tcp_socket sck(self->self_io_engine());
+			if (sck.connect(self, "127.0.0.1", 1245).ok)
+			{
+				char buf[16] = { 0 };
+				for (size_t i = 0; i < rounds; i++)
+				{
+					if (!sck.write(self, buf, 1).ok || !sck.read(self, buf, 1).ok)
+					{
+						break;
+					}
+				}
+			}
+			self->child_wait_quit(srv);
+			sck.close();
+			acc.close();
+		}
+	});
+	ah->run();
+	ah->outside_wait_quit();
+	ios.stop();
+	trace_line("end deadline_list_perfor_test");
+}
+
+void connection_pool_perfor_test()
+{
+	trace_line("begin connection_pool_perfor_test");
+	io_engine ios;
+	ios.run(2);
+	const int clientNum = 8;
+	const int requestNum = 2000;
+	actor_handle ah = my_actor::create(boost_strand::create(ios), [&](my_actor* self)
+	{
+		std::atomic<int> sessions(0);
+		tcp_shard_acceptor acc(ios);
+		tcp_socket::result res = acc.open("127.0.0.1", 1246, [&sessions](const shared_strand& strand, std::shared_ptr<tcp_socket>&& socket)
+		{
+			sessions++;
+			my_actor::create(strand, std::bind([&sessions](my_actor* self, std::shared_ptr<tcp_socket>& socket)
+			{
+				char buf[128];
+				tcp_socket::result res;
+				while ((res = socket->read_some(self, buf, sizeof(buf))).ok && socket->write(self, buf, res.s).ok) {}
+				socket->close();
+				sessions--;
+			}, __1, std::move(socket)))->run();
+		}, 1);
+		if (!res.ok)
+		{
+			trace_line("server port conflict");
+			return;
+		}
+		const boost::asio::ip::tcp::endpoint ep = tcp_socket::make_endpoint("127.0.0.1", 1246);
+		for (int mode = 0; mode < 2; mode++)
+		{
+			tcp_connection_pool pool(ios, clientNum);
+			if (mode)
+			{
+				res = pool.warm_up(self, ep, clientNum);
+				trace_line("warm up ", res.s, " connections");
+			}
+			long long tk = get_tick_us();
+			std::list<actor_handle> clients;
+			for (int i = 0; i < clientNum; i++)
+			{
+				clients.push_back(my_actor::create(boost_strand::create(ios), [&](my_actor* self)
+				{
+					char req[100];
+					char rsp[100];
+					memset(req, 'q', sizeof(req));
+					for (int j = 0; j < requestNum; j++)
+					{
+						std::shared_ptr<tcp_socket> sck;
+						if (mode)
+						{
+							if (!pool.checkout(self, ep, sck).ok)
+							{
+								break;
+							}
+						}
+						else
+						{
+							sck.reset(new tcp_socket(self->self_io_engine()));
+							if (!sck->connect(self, ep).ok)
+							{
+								sck->close();
+								break;
+							}
+						}
+						bool ok = sck->write(self, req, sizeof(req)).ok && sck->read(self, rsp, sizeof(rsp)).ok;
+						if (mode)
+						{
+							pool.checkin(ep, std::move(sck), ok);
+						}
+						else
+						{
+							sck->close();
+						}
+					}
+				}));
+				clients.back()->run();
+			}
+			self->actors_wait_quit(clients);
+			trace_line(mode ? "pooled" : "connect per request", " requests=", clientNum * requestNum, ", connects=", mode ? pool.connect_count() : clientNum * requestNum, ", time=", get_tick_us() - tk, "us");
+			pool.clear();
+		}
+		while (sessions)
+		{
+			self->sleep(1);
+		}
+		acc.close(self);
+	});
+	ah->run();
+	ah->outside_wait_quit();
+	ios.stop();
+	trace_line("end connection_pool_perfor_test");
+}
+
+#ifdef __linux__
+void splice_relay_perfor_test()
+{
+	trace_line("begin splice_relay_perfor_test");
+	io_engine ios;
+	ios.run(3);
+	const size_t totalBytes = 1024 * 1024 * 1024;
+	actor_handle ah = my_actor::create(boost_strand::create(ios), [&](my_actor* self)
+	{
+		for (int mode = 0; mode < 2; mode++)
+		{
+			tcp_acceptor sinkAcc(self->self_io_engine());
+			tcp_acceptor proxyAcc(self->self_io_engine());
+			if (!sinkAcc.open("127.0.0.1", 1241).ok || !proxyAcc.open("127.0.0.1", 1242).ok)
+			{
+				trace_line("server port conflict");
+				return;
+			}
+			size_t sinkBytes = 0;
+			child_handle sink = self->create_child(boost_strand::create(ios), [&](my_actor* self)
+			{
+				tcp_socket sck(self->self_io_engine());
+				if (sinkAcc.accept(self, sck).ok)
+				{
+					std::vector<char> buf(1024 * 1024);
+					tcp_socket::result res;
+					while ((res = sck.read_some(self, &buf[0], buf.size())).ok)
+					{
+						sinkBytes += res.s;
+					}
+				}
+				sck.close();
+			});
+			child_handle proxy = self->create_child(boost_strand::create(ios), [&](my_actor* self)
+			{
+				tcp_socket down(self->self_io_engine());
+				tcp_socket up(self->self_io_engine());
+				if (proxyAcc.accept(self, down).ok && up.connect(self, "127.0.0.1", 1241).ok)
+				{
+					if (mode)
+					{
+						tcp_splice_pipe pipe(1024 * 1024);
+						pipe.relay(self, down, up);
+					}
+					else
+					{
+						std::vector<char> buf(256 * 1024);
+						tcp_socket::result res;
+						while ((res = down.read_some(self, &buf[0], buf.size())).ok && up.write(self, &buf[0], res.s).ok) {}
+					}
+				}
+				up.close();
+				down.close();
+			});
+			self->child_run(sink, proxy);
+			tcp_socket sck(self->self_io_engine());
+			long long tk = get_tick_us();
+			if (sck.connect(self, "127.0.0.1", 1242).ok)
+			{
+				std::vector<char> payload(1024 * 1024, 's');
+				for (size_t sent = 0; sent < totalBytes; sent += payload.size())
+				{
+					if (!sck.write(self, &payload[0], payload.size()).ok)
+					{
+						break;
+					}
+				}
+			}
+			sck.close();
+			self->child_wait_quit(proxy, sink);
+			trace_line(mode ? "splice relay" : "read/write relay", " total=", sinkBytes / (1024 * 1024), "MB, time=", get_tick_us() - tk, "us");
+			proxyAcc.close();
+			sinkAcc.close();
+		}
+	});
+	ah->run();
+	ah->outside_wait_quit();
+	ios.stop();
+	trace_line("end splice_relay_perfor_test");
+}
+#endif
+
+#ifdef BOOST_ASIO_HAS_LOCAL_SOCKETS
+template <typename Socket>
+void local_socket_bench(my_actor* self, Socket& cli, Socket& srv, const char* name)
+{
+	const int rounds = 100000;
+	const size_t totalBytes = 1024 * 1024 * 1024;
+	child_handle echo = self->create_child(boost_strand::create(self->self_io_engine()), [&](my_actor* self)
+	{
+		char buf[8];
+		for (int i = 0; i < rounds && srv.read(self, buf, sizeof(buf)).ok && srv.write(self, buf, sizeof(buf)).ok; i++) {}
+		std::vector<char> data(256 * 1024);
+		socket_result res;
+		for (size_t n = 0; n < totalBytes && (res = srv.read_some(self, &data[0], data.size())).ok; n += res.s) {}
+	});
+	self->child_run(echo);
+	char buf[8] = { 0 };
+	long long tk = get_tick_us();
+	for (int i = 0; i < rounds && cli.write(self, buf, sizeof(buf)).ok && cli.read(self, buf, sizeof(buf)).ok; i++) {}
+	const long long rtt = (get_tick_us() - tk) * 1000 / rounds;
+	std::vector<char> payload(256 * 1024, 'l');
+	tk = get_tick_us();
+	for (size_t sent = 0; sent < totalBytes && cli.write(self, &payload[0], payload.size()).ok; sent += payload.size()) {}
+	self->child_wait_quit(echo);
+	trace_line(name, " rtt=", rtt, "ns, total=", totalBytes / (1024 * 1024), "MB, time=", get_tick_us() - tk, "us");
+}
+
+void unix_socket_perfor_test()
+{
+	trace_line("begin unix_socket_perfor_test");
+	io_engine ios;
+	ios.run(2);
+	actor_handle ah = my_actor::create(boost_strand::create(ios), [&](my_actor* self)
+	{
+		{
+			tcp_acceptor acc(self->self_io_engine());
+			if (!acc.open("127.0.0.1", 1243).ok)
+			{
+				trace_line("server port conflict");
+				return;
+			}
+			tcp_socket srv(self->self_io_engine());
+			tcp_socket cli(self->self_io_engine());
+			child_handle accepter = self->create_child([&](my_actor* self)
+			{
+				acc.accept(self, srv);
+			});
+			self->child_run(accepter);
+			cli.connect(self, "127.0.0.1", 1243);
+			self->child_wait_quit(accepter);
+			cli.no_delay();
+			srv.no_delay();
+			local_socket_bench(self, cli, srv, "tcp loopback");
+			cli.close();
+			srv.close();
+			acc.close();
+		}
+		{
+			unix_acceptor acc(self->self_io_engine());
+			if (!acc.open("@my_actor_unix_perfor_test").ok)
+			{
+				trace_line("unix path conflict");
+				return;
+			}
+			unix_socket srv(self->self_io_engine());
+			unix_socket cli(self->self_io_engine());
+			child_handle accepter = self->create_child([&](my_actor* self)
+			{
+				acc.accept(self, srv);
+			});
+			self->child_run(accepter);
+			cli.connect(self, "@my_actor_unix_perfor_test");
+			self->child_wait_quit(accepter);
+			local_socket_bench(self, cli, srv, "unix stream");
+			//通过SCM_RIGHTS传递管道写端，对端经收到的描述符写入
+			int pipeFds[2];
+			if (0 == pipe(pipeFds))
+			{
+				const char tag = 'f';
+				cli.send_fds(self, &tag, 1, &pipeFds[1], 1);
+				char recvTag = 0;
+				int fd = -1;
+				size_t fdCount = 1;
+				if (srv.recv_fds(self, &recvTag, 1, &fd, fdCount).ok && 1 == fdCount)
+				{
+					const char msg[] = "fd passed";
+					char buf[sizeof(msg)] = { 0 };
+					if (::write(fd, msg, sizeof(msg)) > 0 && ::read(pipeFds[0], buf, sizeof(buf)) > 0)
+					{
+						trace_line("scm_rights: ", buf);
+					}
+					close(fd);
+				}
+				close(pipeFds[0]);
+				close(pipeFds[1]);
+			}
+			cli.close();
+			srv.close();
+			acc.close();
+		}
+	});
+	ah->run();
+	ah->outside_wait_quit();
+	ios.stop();
+	trace_line("end unix_socket_perfor_test");
+}
+#endif
+
+template <size_t N>
+struct emplace_test_msg
+{
+	emplace_test_msg(int i)
+	{
+		memset(_buff, i, sizeof(_buff));
+	}
+
+	emplace_test_msg(const emplace_test_msg& s)
+	{
+		memcpy(_buff, s._buff, sizeof(_buff));
+	}
+
+	char _buff[N];
+};
+
+template <size_t N>
+void emplace_msg_perfor_test(my_actor* self)
+{
+	typedef emplace_test_msg<N> msg_type;
+	const int num = 1000000;
+	const int batch = 8;
+	long long sum = 0;
+	{
+		msg_handle<msg_type> amh;
+		child_handle ch = self->create_child([&](my_actor* self)
+		{
+			for (int i = 0; i < num; i++)
+			{
+				msg_type msg(0);
+				self->wait_msg(amh, msg);
+				sum += msg._buff[0];
+			}
+		});
+		auto ntf = self->make_msg_notifer_to(ch, amh);
+		self->child_run(ch);
+		long long tk = get_tick_us();
+		for (int i = 0; i < num; i += batch)
+		{
+			for (int j = 0; j < batch; j++)
+			{
+				ntf(msg_type(j));
+			}
+			self->yield();
+		}
+		self->child_wait_quit(ch);
+		trace_line("msg size=", N, ", operator() + wait_msg time=", get_tick_us() - tk, "us");
+	}
+	{
+		msg_handle<msg_type> amh;
+		child_handle ch = self->create_child([&](my_actor* self)
+		{
+			for (int i = 0; i < num; i++)
+			{
+				sum += std::get<0>(self->wait_msg_ref(amh))._buff[0];
+			}
+		});
+		auto ntf = self->make_msg_notifer_to(ch, amh);
+		self->child_run(ch);
+		long long tk = get_tick_us();
+		for (int i = 0; i < num; i += batch)
+		{
+			for (int j = 0; j < batch; j++)
+			{
+				ntf.emplace(j);
+			}
+			self->yield();
+		}
+		self->child_wait_quit(ch);
+		trace_line("msg size=", N, ", emplace + wait_msg_ref time=", get_tick_us() - tk, "us");
+	}
+	trace_line(sum);
+}
+
+void emplace_msg_perfor_test()
+{
+	trace_line("begin emplace_msg_perfor_test");
+	io_engine ios;
+	ios.run(1);
+	actor_handle ah = my_actor::create(boost_strand::create(ios), [](my_actor* self)
+	{
+		emplace_msg_perfor_test<256>(self);
+		emplace_msg_perfor_test<4096>(self);
+	});
+	ah->run();
+	ah->outside_wait_quit();
+	ios.stop();
+	trace_line("end emplace_msg_perfor_test");
+}
+
 void co_convar_test()
 {
 	trace_line("begin co_convar_test");
@@ -1375,6 +3016,54 @@ void co_msg_test()
 	trace_line("end co_msg_test");
 }
 
+void co_msg_spill_test()
+{
+	trace_line("begin co_msg_spill_test");
+	io_engine ios;
+	ios.run();
+	//spill_size只能在msgBuff的strand中调用，两端都运行在该strand上
+	shared_strand strand = boost_strand::create(ios);
+	co_msg_buffer<int, long long> msgBuff(strand);
+	msgBuff.enable_spill("./co_msg_spill_test", 1024, 4096);
+	const int msgNum = 100000;
+	co_go(strand)[&](co_generator)
+	{
+		co_begin_context;
+		int i;
+		co_use_state;
+		co_end_context(ctx);
+
+		co_begin;
+		for (ctx.i = 0; ctx.i < msgNum; ctx.i++)
+		{
+			co_chan_io(msgBuff) << co_chan_multi(ctx.i, (long long)ctx.i * ctx.i);
+		}
+		trace_line("spill size ", msgBuff.spill_size());
+		co_end;
+	};
+	co_go(strand)[&](co_generator)
+	{
+		co_begin_context;
+		int i;
+		int id;
+		long long sq;
+		co_use_state;
+		co_end_context(ctx);
+
+		co_begin;
+		co_sleep(500);
+		for (ctx.i = 0; ctx.i < msgNum; ctx.i++)
+		{
+			co_chan_io(msgBuff) >> co_chan_multi(ctx.id, ctx.sq);
+			assert(ctx.i == ctx.id && (long long)ctx.i * ctx.i == ctx.sq);
+		}
+		trace_line("spill size ", msgBuff.spill_size());
+		co_end;
+	};
+	ios.stop();
+	trace_line("end co_msg_spill_test");
+}
+
 void co_channel_test()
 {
 	trace_line("begin co_channel_test");
@@ -1466,6 +3155,8 @@ int main(int argc, char *argv[])
 	trace("\n");
 	co_msg_test();
 	trace("\n");
+	co_msg_spill_test();
+	trace("\n");
 	co_broadcast_test();
 	trace("\n");
 #ifdef NDEBUG
@@ -1481,6 +3172,54 @@ int main(int argc, char *argv[])
 #ifdef NDEBUG
 	co_perfor_test();
 	trace("\n");
+	co_bulk_go_perfor_test();
+	trace("\n");
+	id_alloc_perfor_test();
+	trace("\n");
+	fork_join_perfor_test();
+	trace("\n");
+	msg_pool_perfor_test();
+	trace("\n");
+	multicast_perfor_test();
+	trace("\n");
+	agent_chain_perfor_test();
+	trace("\n");
+	mailbox_lane_perfor_test();
+	trace("\n");
+	ask_perfor_test();
+	trace("\n");
+	check_lost_perfor_test();
+	trace("\n");
+	quit_notify_perfor_test();
+	trace("\n");
+	mass_force_quit_perfor_test();
+	trace("\n");
+	shard_accept_perfor_test();
+	trace("\n");
+	socket_writev_perfor_test();
+	trace("\n");
+	frame_reader_perfor_test();
+	trace("\n");
+	zero_copy_perfor_test();
+	trace("\n");
+	udp_gso_perfor_test();
+	trace("\n");
+	cork_write_perfor_test();
+	trace("\n");
+	deadline_list_perfor_test();
+	trace("\n");
+	connection_pool_perfor_test();
+	trace("\n");
+#ifdef __linux__
+	splice_relay_perfor_test();
+	trace("\n");
+#endif
+#ifdef BOOST_ASIO_HAS_LOCAL_SOCKETS
+	unix_socket_perfor_test();
+	trace("\n");
+#endif
+	emplace_msg_perfor_test();
+	trace("\n");
 #endif
 	auto_stack_test();
 	trace("\n");
@@ -29,6 +29,7 @@ ENABLE_ASIO_PRE_OP 启用tcp/udp在async_io时先尝试非阻塞io，失败后
 #include "context_yield.cpp"
 #include "generator.cpp"
 #include "io_engine.cpp"
+#include "msg_spill.cpp"
 #include "my_actor.cpp"
 #include "qt_strand.cpp"
 #include "run_thread.cpp"
@@ -36,6 +37,7 @@ ENABLE_ASIO_PRE_OP 启用tcp/udp在async_io时先尝试非阻塞io，失败后
 #include "shared_strand.cpp"
 #include "strand_ex.cpp"
 #include "trace_stack.cpp"
+#include "unix_socket.cpp"
 #include "uv_strand.cpp"
 #include "waitable_timer.cpp"
 
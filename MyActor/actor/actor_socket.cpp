@@ -1,7 +1,135 @@
+#include <algorithm>
 #include "actor_socket.h"
+#if (defined __linux__) && (defined SO_ZEROCOPY)
+#include <linux/errqueue.h>
+#define HAS_SCK_ZERO_COPY
+#endif
+#ifdef __linux__
+#include <netinet/udp.h>
+#ifdef UDP_SEGMENT
+#define HAS_UDP_GSO
+//单次GSO发送的最大分段数与最大字节数
+#define UDP_GSO_MAX_SEGMENTS 64
+#define UDP_GSO_MAX_BYTES 65000
+#endif
+#ifdef UDP_GRO
+#define HAS_UDP_GRO
+#endif
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+socket_deadline_list::socket_deadline_list(const shared_strand& strand, int tickMs)
+:_strand(strand), _timer(strand->make_timer()), _now(get_tick_us()), _expiredCount(0), _tickMs(tickMs)
+{
+	assert(tickMs > 0);
+}
+
+socket_deadline_list::~socket_deadline_list()
+{
+	assert(_nodes.empty());
+	_timer->cancel();
+}
+
+const shared_strand& socket_deadline_list::self_strand()
+{
+	return _strand;
+}
+
+size_t socket_deadline_list::size()
+{
+	return _nodes.size();
+}
+
+size_t socket_deadline_list::expired_count()
+{
+	return _expiredCount;
+}
+
+socket_deadline_list::node* socket_deadline_list::attach(void* owner, void(*cancel)(void* owner, int slot))
+{
+	assert(_strand->running_in_this_thread());
+	node* nd = new node;
+	nd->_list = this;
+	nd->_owner = owner;
+	nd->_cancel = cancel;
+	for (int i = 0; i < slot_count; i++)
+	{
+		nd->_deadline[i] = -1;
+		nd->_expired[i] = false;
+	}
+	nd->_index = _nodes.size();
+	_nodes.push_back(nd);
+	if (1 == _nodes.size())
+	{
+		_now = get_tick_us();
+		_timer->interval(_tickMs, [this]()
+		{
+			tick();
+		});
+	}
+	return nd;
+}
+
+void socket_deadline_list::detach(node* nd)
+{
+	assert(_strand->running_in_this_thread());
+	assert(nd->_list == this && _nodes[nd->_index] == nd);
+	_nodes[nd->_index] = _nodes.back();
+	_nodes[nd->_index]->_index = nd->_index;
+	_nodes.pop_back();
+	delete nd;
+	if (_nodes.empty())
+	{
+		_timer->cancel();
+	}
+}
+
+void socket_deadline_list::begin(node* nd, int slot, int ms)
+{
+	assert(nd->_list->_strand->running_in_this_thread());
+	//_now最多滞后一个tick，补上一个tick保证不会提前超时
+	nd->_deadline[slot] = nd->_list->_now + ((long long)ms + nd->_list->_tickMs) * 1000;
+	nd->_expired[slot] = false;
+}
+
+socket_result socket_deadline_list::end(node* nd, int slot, const socket_result& res)
+{
+	nd->_deadline[slot] = -1;
+	if (nd->_expired[slot])
+	{
+		nd->_expired[slot] = false;
+		if (!res.ok)
+		{
+			return socket_result{ res.s, boost::asio::error::timed_out, false };
+		}
+	}
+	return res;
+}
+
+void socket_deadline_list::tick()
+{
+	_now = get_tick_us();
+	//取消回调不会增删登记项，可以直接遍历
+	for (size_t i = 0; i < _nodes.size(); i++)
+	{
+		node* nd = _nodes[i];
+		for (int j = 0; j < slot_count; j++)
+		{
+			if (-1 != nd->_deadline[j] && nd->_deadline[j] <= _now)
+			{
+				nd->_deadline[j] = -1;
+				nd->_expired[j] = true;
+				_expiredCount++;
+				nd->_cancel(nd->_owner, j);
+			}
+		}
+	}
+}
+//////////////////////////////////////////////////////////////////////////
 
 tcp_socket::tcp_socket(io_engine& ios)
-:_socket(ios), _holdRead(false), _holdWrite(false), _cancelRead(false), _cancelWrite(false), _nonBlocking(false)
+:_socket(ios), _deadline(NULL), _holdRead(false), _holdWrite(false), _cancelRead(false), _cancelWrite(false), _nonBlocking(false)
 #ifdef ENABLE_ASIO_PRE_OP
 , _preOption(false)
 #endif
@@ -21,13 +149,36 @@ tcp_socket::tcp_socket(io_engine& ios)
 tcp_socket::~tcp_socket()
 {
 	assert(!is_open());
+	set_deadline_list(NULL);
 }
 
 tcp_socket::result tcp_socket::close()
 {
 	boost::system::error_code ec;
 	_socket.shutdown(boost::asio::ip::tcp::socket::shutdown_both, ec);
+#ifdef HAS_SCK_ZERO_COPY
+	if (_zeroCopy && _socket.is_open())
+	{
+		zero_copy_reap();
+		if (_zeroCopy->_doneSeq != _zeroCopy->_sendSeq)
+		{
+			//关闭后发送队列中的数据仍会发出，内核还在读取这些缓存，
+			//dup一个句柄保留错误队列，缓存链等到释放通知到达后再释放
+			const int fd = ::dup(_socket.native_handle());
+			if (fd >= 0)
+			{
+				zero_copy_orphan(fd, std::move(_zeroCopy));
+			}
+			else
+			{
+				//拿不到释放通知，宁可泄漏也不能让内存被复用
+				_zeroCopy.release();
+			}
+		}
+	}
+#endif
 	_socket.close(ec);
+	_zeroCopy.reset();
 	return result{ 0, ec.value(), !ec };
 }
 
@@ -50,6 +201,7 @@ void tcp_socket::swap(tcp_socket& other)
 	std::swap(_cancelRead, other._cancelRead);
 	std::swap(_cancelWrite, other._cancelWrite);
 	std::swap(_nonBlocking, other._nonBlocking);
+	_zeroCopy.swap(other._zeroCopy);
 #ifdef ENABLE_ASIO_PRE_OP
 	std::swap(_preOption, other._preOption);
 #endif
@@ -222,6 +374,30 @@ tcp_socket::result tcp_socket::cancel_write()
 	return result{ 0, ec.value(), !ec };
 }
 
+void tcp_socket::set_deadline_list(socket_deadline_list* deadlines)
+{
+	if (_deadline && _deadline->_list != deadlines)
+	{
+		_deadline->_list->detach(_deadline);
+		_deadline = NULL;
+	}
+	if (deadlines && !_deadline)
+	{
+		_deadline = deadlines->attach(this, &tcp_socket::deadline_cancel);
+	}
+}
+
+void tcp_socket::deadline_cancel(void* owner, int slot)
+{
+	tcp_socket* sck = (tcp_socket*)owner;
+	switch (slot)
+	{
+	case socket_deadline_list::read_slot: sck->cancel_read(); break;
+	case socket_deadline_list::write_slot: sck->cancel_write(); break;
+	default: sck->cancel(); break;
+	}
+}
+
 tcp_socket::result tcp_socket::read_some(my_actor* host, void* buff, size_t length)
 {
 	my_actor::quit_guard qg(host);
@@ -249,12 +425,41 @@ tcp_socket::result tcp_socket::write_some(my_actor* host, const void* buff, size
 	});
 }
 
+tcp_socket::result tcp_socket::readv(my_actor* host, const boost::asio::mutable_buffer* buffs, size_t count)
+{
+	my_actor::quit_guard qg(host);
+	return host->trig<result>([&](trig_once_notifer<result>&& h)
+	{
+		async_readv(buffs, count, std::move(h));
+	});
+}
+
+tcp_socket::result tcp_socket::writev(my_actor* host, const boost::asio::const_buffer* buffs, size_t count)
+{
+	my_actor::quit_guard qg(host);
+	return host->trig<result>([&](trig_once_notifer<result>&& h)
+	{
+		async_writev(buffs, count, std::move(h));
+	});
+}
+
+tcp_socket::result tcp_socket::write(my_actor* host, const buffer_chain& chain)
+{
+	return writev(host, chain.buffers(), chain.count());
+}
+
 tcp_socket::result tcp_socket::timed_connect(my_actor* host, int ms, const boost::asio::ip::tcp::endpoint& remoteEndpoint)
 {
 	bool overtime = false;
 	result res = { 0, 0, false };
 	my_actor::quit_guard qg(host);
-	if (ms > 0)
+	if (ms > 0 && _deadline)
+	{
+		socket_deadline_list::begin(_deadline, socket_deadline_list::other_slot, ms);
+		async_connect(remoteEndpoint, host->make_asio_context(res));
+		return socket_deadline_list::end(_deadline, socket_deadline_list::other_slot, res);
+	}
+	else if (ms > 0)
 	{
 		async_connect(remoteEndpoint, host->make_asio_timed_context(ms, [&]()
 		{
@@ -274,12 +479,98 @@ tcp_socket::result tcp_socket::timed_connect(my_actor* host, int ms, const char*
 	return timed_connect(host, ms, make_endpoint(remoteIp, remotePort));
 }
 
+tcp_socket::result tcp_socket::timed_connect_n(my_actor* host, int ms, const boost::asio::ip::tcp::endpoint& remoteEndpoint, tcp_socket* const* sockets, size_t count, result* results)
+{
+	if (!count)
+	{
+		return result{ 0, 0, true };
+	}
+	std::vector<result> resultsBuff;
+	if (!results)
+	{
+		resultsBuff.resize(count);
+		results = &resultsBuff[0];
+	}
+	std::vector<char> done(count, 0);
+	size_t remain = count;
+	bool overtime = false;
+	const shared_strand& strand = host->self_strand();
+	stack_obj<trig_once_notifer<> > allDone;
+	my_actor::quit_guard qg(host);
+	if (ms > 0)
+	{
+		host->delay_trig(ms, [&]()
+		{
+			overtime = true;
+			for (size_t i = 0; i < count; i++)
+			{
+				if (!done[i])
+				{
+					sockets[i]->cancel();
+				}
+			}
+		});
+	}
+	host->trig([&](trig_once_notifer<>&& ntf)
+	{
+		allDone.create(std::move(ntf));
+		for (size_t i = 0; i < count; i++)
+		{
+			sockets[i]->async_connect(remoteEndpoint, [&, i](const result& res)
+			{
+				strand->distribute([&, i, res]()
+				{
+					results[i] = res;
+					done[i] = 1;
+					if (0 == --remain)
+					{
+						allDone.get()();
+					}
+				});
+			});
+		}
+	});
+	if (ms > 0)
+	{
+		host->cancel_delay_trig();
+	}
+	size_t connected = 0;
+	int code = 0;
+	for (size_t i = 0; i < count; i++)
+	{
+		if (results[i].ok)
+		{
+			connected++;
+		}
+		else
+		{
+			if (overtime)
+			{
+				results[i].code = boost::asio::error::timed_out;
+			}
+			code = code ? code : results[i].code;
+		}
+	}
+	return result{ connected, code, connected == count };
+}
+
+tcp_socket::result tcp_socket::connect_n(my_actor* host, const boost::asio::ip::tcp::endpoint& remoteEndpoint, tcp_socket* const* sockets, size_t count, result* results)
+{
+	return timed_connect_n(host, -1, remoteEndpoint, sockets, count, results);
+}
+
 tcp_socket::result tcp_socket::timed_read(my_actor* host, int ms, void* buff, size_t length)
 {
 	bool overtime = false;
 	result res = { 0, 0, false };
 	my_actor::quit_guard qg(host);
-	if (ms > 0)
+	if (ms > 0 && _deadline)
+	{
+		socket_deadline_list::begin(_deadline, socket_deadline_list::read_slot, ms);
+		async_read(buff, length, host->make_asio_context(res));
+		return socket_deadline_list::end(_deadline, socket_deadline_list::read_slot, res);
+	}
+	else if (ms > 0)
 	{
 		async_read(buff, length, host->make_asio_timed_context(ms, [&]()
 		{
@@ -299,7 +590,13 @@ tcp_socket::result tcp_socket::timed_read_some(my_actor* host, int ms, void* buf
 	bool overtime = false;
 	result res = { 0, 0, false };
 	my_actor::quit_guard qg(host);
-	if (ms > 0)
+	if (ms > 0 && _deadline)
+	{
+		socket_deadline_list::begin(_deadline, socket_deadline_list::read_slot, ms);
+		async_read_some(buff, length, host->make_asio_context(res));
+		return socket_deadline_list::end(_deadline, socket_deadline_list::read_slot, res);
+	}
+	else if (ms > 0)
 	{
 		async_read_some(buff, length, host->make_asio_timed_context(ms, [&]()
 		{
@@ -319,7 +616,13 @@ tcp_socket::result tcp_socket::timed_write(my_actor* host, int ms, const void* b
 	bool overtime = false;
 	result res = { 0, 0, false };
 	my_actor::quit_guard qg(host);
-	if (ms > 0)
+	if (ms > 0 && _deadline)
+	{
+		socket_deadline_list::begin(_deadline, socket_deadline_list::write_slot, ms);
+		async_write(buff, length, host->make_asio_context(res));
+		return socket_deadline_list::end(_deadline, socket_deadline_list::write_slot, res);
+	}
+	else if (ms > 0)
 	{
 		async_write(buff, length, host->make_asio_timed_context(ms, [&]()
 		{
@@ -339,7 +642,13 @@ tcp_socket::result tcp_socket::timed_write_some(my_actor* host, int ms, const vo
 	bool overtime = false;
 	result res = { 0, 0, false };
 	my_actor::quit_guard qg(host);
-	if (ms > 0)
+	if (ms > 0 && _deadline)
+	{
+		socket_deadline_list::begin(_deadline, socket_deadline_list::write_slot, ms);
+		async_write_some(buff, length, host->make_asio_context(res));
+		return socket_deadline_list::end(_deadline, socket_deadline_list::write_slot, res);
+	}
+	else if (ms > 0)
 	{
 		async_write_some(buff, length, host->make_asio_timed_context(ms, [&]()
 		{
@@ -354,86 +663,417 @@ tcp_socket::result tcp_socket::timed_write_some(my_actor* host, int ms, const vo
 	return (overtime && !res.ok) ? result{ res.s, boost::asio::error::timed_out, false } : res;
 }
 
-tcp_socket::result tcp_socket::try_write_same(const void* buff, size_t length)
+tcp_socket::result tcp_socket::timed_readv(my_actor* host, int ms, const boost::asio::mutable_buffer* buffs, size_t count)
 {
-	using namespace boost::asio::detail;
+	bool overtime = false;
 	result res = { 0, 0, false };
-	if (_nonBlocking)
+	my_actor::quit_guard qg(host);
+	if (ms > 0 && _deadline)
 	{
-		socket_ops::buf buf;
-		socket_ops::init_buf(buf, buff, length);
-		boost::system::error_code ec;
-		signed_size_type bytes = socket_ops::send(_socket.native_handle(), &buf, 1, 0, ec);
-		if (bytes >= 0 && !ec)
-		{
-			res.ok = true;
-			res.s = (size_t)bytes;
-		}
-		else
+		socket_deadline_list::begin(_deadline, socket_deadline_list::read_slot, ms);
+		async_readv(buffs, count, host->make_asio_context(res));
+		return socket_deadline_list::end(_deadline, socket_deadline_list::read_slot, res);
+	}
+	else if (ms > 0)
+	{
+		async_readv(buffs, count, host->make_asio_timed_context(ms, [&]()
 		{
-			res.code = ec.value();
-		}
+			overtime = true;
+			cancel_read();
+		}, res));
 	}
 	else
 	{
-		res.code = boost::asio::error::would_block;
+		async_readv(buffs, count, host->make_asio_context(res));
 	}
-	return res;
+	return (overtime && !res.ok) ? result{ res.s, boost::asio::error::timed_out, false } : res;
 }
 
-tcp_socket::result tcp_socket::try_read_same(void* buff, size_t length)
+tcp_socket::result tcp_socket::timed_writev(my_actor* host, int ms, const boost::asio::const_buffer* buffs, size_t count)
 {
-	using namespace boost::asio::detail;
+	bool overtime = false;
 	result res = { 0, 0, false };
-	if (_nonBlocking)
+	my_actor::quit_guard qg(host);
+	if (ms > 0 && _deadline)
 	{
-		socket_ops::buf buf;
-		socket_ops::init_buf(buf, buff, length);
-		boost::system::error_code ec;
-		signed_size_type bytes = socket_ops::recv(_socket.native_handle(), &buf, 1, 0, ec);
-		if (bytes >= 0 && !ec)
-		{
-			res.ok = true;
-			res.s = (size_t)bytes;
-		}
-		else
+		socket_deadline_list::begin(_deadline, socket_deadline_list::write_slot, ms);
+		async_writev(buffs, count, host->make_asio_context(res));
+		return socket_deadline_list::end(_deadline, socket_deadline_list::write_slot, res);
+	}
+	else if (ms > 0)
+	{
+		async_writev(buffs, count, host->make_asio_timed_context(ms, [&]()
 		{
-			res.code = ec.value();
-		}
+			overtime = true;
+			cancel_write();
+		}, res));
 	}
 	else
 	{
-		res.code = boost::asio::error::would_block;
+		async_writev(buffs, count, host->make_asio_context(res));
+	}
+	return (overtime && !res.ok) ? result{ res.s, boost::asio::error::timed_out, false } : res;
+}
+
+tcp_socket::result tcp_socket::timed_write(my_actor* host, int ms, const buffer_chain& chain)
+{
+	return timed_writev(host, ms, chain.buffers(), chain.count());
+}
+
+tcp_socket::result tcp_socket::zero_copy(size_t threshold)
+{
+#ifdef HAS_SCK_ZERO_COPY
+	const int one = 1;
+	if (0 != ::setsockopt(_socket.native_handle(), SOL_SOCKET, SO_ZEROCOPY, &one, sizeof(one)))
+	{
+		return result{ 0, errno, false };
+	}
+	if (!_zeroCopy)
+	{
+		_zeroCopy.reset(new zero_copy_state);
+		_zeroCopy->_sendSeq = 0;
+		_zeroCopy->_doneSeq = 0;
+	}
+	_zeroCopy->_threshold = threshold;
+	zero_copy_reap_orphans();
+	return result{ 0, 0, true };
+#else
+	return result{ 0, boost::asio::error::operation_not_supported, false };
+#endif
+}
+
+tcp_socket::result tcp_socket::zero_copy_write(my_actor* host, const void* buff, size_t length)
+{
+	if (!_zeroCopy || length < _zeroCopy->_threshold)
+	{
+		return write(host, buff, length);
+	}
+	const boost::asio::const_buffer buffer(buff, length);
+	result res = zero_copy_send(host, &buffer, 1);
+	result fr = zero_copy_flush(host);
+	if (res.ok && !fr.ok)
+	{
+		res.ok = false;
+		res.code = fr.code;
 	}
 	return res;
 }
 
-tcp_socket::result tcp_socket::try_mwrite_same(const void* const* buffs, const size_t* lengths, size_t count, size_t* lastBytes)
+tcp_socket::result tcp_socket::zero_copy_write(my_actor* host, const buffer_chain& chain)
 {
-#ifdef ENABLE_SCK_MULTI_IO
-	if (!lastBytes)
+	if (!_zeroCopy || chain.size() < _zeroCopy->_threshold)
 	{
-		return _try_mwrite_same(buffs, lengths, count);
+		return write(host, chain);
+	}
+	const unsigned lastSeq = _zeroCopy->_sendSeq;
+	result res = zero_copy_send(host, chain.buffers(), chain.count());
+	if (_zeroCopy && lastSeq != _zeroCopy->_sendSeq)
+	{
+		_zeroCopy->_holders.push_back(std::make_pair(_zeroCopy->_sendSeq - 1, chain));
+	}
+	return res;
+}
+
+tcp_socket::result tcp_socket::zero_copy_flush(my_actor* host)
+{
+	int us = 50;
+	while (_zeroCopy)
+	{
+		zero_copy_reap();
+		if (_zeroCopy->_doneSeq == _zeroCopy->_sendSeq)
+		{
+			break;
+		}
+		//释放通知在错误队列中，没有可靠的就绪事件，退避轮询
+		host->usleep(us);
+		us = us < 1000 ? 2 * us : us;
 	}
+	return result{ 0, 0, true };
+}
+
+tcp_socket::result tcp_socket::zero_copy_send(my_actor* host, const boost::asio::const_buffer* buffs, size_t count)
+{
 	result res = { 0, 0, false };
-	size_t i = 0;
-	while (true)
+#ifdef HAS_SCK_ZERO_COPY
+	SocketIov_<boost::asio::const_buffer> iov(buffs, count);
+	while (!iov.completed())
 	{
-		struct iovec msgs[32];
-		struct mmsghdr mhdr[32];
+		struct iovec msgs[64];
 		size_t ct = 0;
-		for (; ct < fixed_array_length(msgs); ct++)
+		for (SocketIov_<boost::asio::const_buffer>::const_iterator it = iov.begin(); it != iov.end() && ct < fixed_array_length(msgs); ++it, ct++)
 		{
-			size_t k = i*fixed_array_length(msgs) + ct;
-			if (k >= count)
-			{
-				break;
-			}
-			msgs[ct].iov_base = (void*)buffs[k];
-			msgs[ct].iov_len = lengths[k];
-			memset(&mhdr[ct], 0, sizeof(mhdr[ct]));
-			mhdr[ct].msg_hdr.msg_iov = &msgs[ct];
-			mhdr[ct].msg_hdr.msg_iovlen = 1;
+			const boost::asio::const_buffer buff = *it;
+			msgs[ct].iov_base = (void*)boost::asio::buffer_cast<const void*>(buff);
+			msgs[ct].iov_len = boost::asio::buffer_size(buff);
+		}
+		struct msghdr mhdr;
+		memset(&mhdr, 0, sizeof(mhdr));
+		mhdr.msg_iov = msgs;
+		mhdr.msg_iovlen = ct;
+		const ssize_t s = ::sendmsg(_socket.native_handle(), &mhdr, MSG_ZEROCOPY | MSG_NOSIGNAL);
+		if (s >= 0)
+		{
+			_zeroCopy->_sendSeq++;
+			res.s += s;
+			iov.advance(s);
+			zero_copy_reap();
+			continue;
+		}
+		const int err = errno;
+		if (EINTR == err)
+		{
+			continue;
+		}
+		if (EAGAIN == err || EWOULDBLOCK == err)
+		{
+			result wr = wait_ready(host, 0, true);
+			if (!wr.ok)
+			{
+				res.code = wr.code;
+				return res;
+			}
+			continue;
+		}
+		if (ENOBUFS == err)
+		{//超过optmem限制，剩余部分回退为普通发送
+			break;
+		}
+		res.code = err;
+		return res;
+	}
+	if (!iov.completed())
+	{
+		const boost::asio::const_buffer head = *iov.begin();
+		result wr = write(host, boost::asio::buffer_cast<const void*>(head), boost::asio::buffer_size(head));
+		res.s += wr.s;
+		if (wr.ok)
+		{
+			wr = writev(host, iov._buffs + iov._index + 1, iov._count - iov._index - 1);
+			res.s += wr.s;
+		}
+		res.code = wr.code;
+		res.ok = wr.ok;
+		return res;
+	}
+	res.ok = true;
+#else
+	res = writev(host, buffs, count);
+#endif
+	return res;
+}
+
+tcp_socket::result tcp_socket::wait_ready(my_actor* host, int ms, bool write)
+{
+	bool overtime = false;
+	boost::system::error_code ec;
+	size_t s = 0;
+	my_actor::quit_guard qg(host);
+	if (ms > 0)
+	{
+		if (write)
+		{
+			_socket.async_write_some(boost::asio::null_buffers(), host->make_asio_timed_context(ms, [&]()
+			{
+				overtime = true;
+				cancel_write();
+			}, ec, s));
+		}
+		else
+		{
+			_socket.async_read_some(boost::asio::null_buffers(), host->make_asio_timed_context(ms, [&]()
+			{
+				overtime = true;
+				cancel_read();
+			}, ec, s));
+		}
+	}
+	else if (write)
+	{
+		_socket.async_write_some(boost::asio::null_buffers(), host->make_asio_context(ec, s));
+	}
+	else
+	{
+		_socket.async_read_some(boost::asio::null_buffers(), host->make_asio_context(ec, s));
+	}
+	return (overtime && ec) ? result{ 0, boost::asio::error::timed_out, false } : result{ 0, ec.value(), !ec };
+}
+
+void tcp_socket::zero_copy_reap()
+{
+#ifdef HAS_SCK_ZERO_COPY
+	zero_copy_reap(_socket.native_handle(), *_zeroCopy);
+	zero_copy_reap_orphans();
+#endif
+}
+
+bool tcp_socket::zero_copy_reap(int fd, zero_copy_state& zc)
+{
+#ifdef HAS_SCK_ZERO_COPY
+	while (zc._doneSeq != zc._sendSeq)
+	{
+		char control[128];
+		struct msghdr mhdr;
+		memset(&mhdr, 0, sizeof(mhdr));
+		mhdr.msg_control = control;
+		mhdr.msg_controllen = sizeof(control);
+		if (::recvmsg(fd, &mhdr, MSG_ERRQUEUE) < 0)
+		{
+			if (EINTR == errno)
+			{
+				continue;
+			}
+			break;
+		}
+		for (struct cmsghdr* cm = CMSG_FIRSTHDR(&mhdr); cm; cm = CMSG_NXTHDR(&mhdr, cm))
+		{
+			if ((SOL_IP == cm->cmsg_level && IP_RECVERR == cm->cmsg_type) || (SOL_IPV6 == cm->cmsg_level && IPV6_RECVERR == cm->cmsg_type))
+			{
+				const struct sock_extended_err* serr = (const struct sock_extended_err*)CMSG_DATA(cm);
+				if (SO_EE_ORIGIN_ZEROCOPY == serr->ee_origin && !serr->ee_errno)
+				{
+					zc._doneSeq += serr->ee_data - serr->ee_info + 1;
+				}
+			}
+		}
+	}
+	//tcp的释放通知按发送顺序到达
+	while (!zc._holders.empty() && (int)(zc._holders.front().first - zc._doneSeq) < 0)
+	{
+		zc._holders.pop_front();
+	}
+	return zc._doneSeq == zc._sendSeq;
+#else
+	return true;
+#endif
+}
+
+std::mutex tcp_socket::_zeroCopyOrphanMutex;
+std::list<std::pair<int, std::unique_ptr<tcp_socket::zero_copy_state> > > tcp_socket::_zeroCopyOrphans;
+
+void tcp_socket::zero_copy_orphan(int fd, std::unique_ptr<zero_copy_state>&& zc)
+{
+	std::lock_guard<std::mutex> lg(_zeroCopyOrphanMutex);
+	_zeroCopyOrphans.push_back(std::make_pair(fd, std::move(zc)));
+}
+
+void tcp_socket::zero_copy_reap_orphans()
+{
+	//由仍在使用零拷贝的socket顺带回收，全部释放后关闭dup出的句柄
+	std::lock_guard<std::mutex> lg(_zeroCopyOrphanMutex);
+	for (auto it = _zeroCopyOrphans.begin(); it != _zeroCopyOrphans.end();)
+	{
+		if (zero_copy_reap(it->first, *it->second))
+		{
+			::close(it->first);
+			it = _zeroCopyOrphans.erase(it);
+		}
+		else
+		{
+			++it;
+		}
+	}
+}
+
+tcp_socket::result tcp_socket::try_write_same(const void* buff, size_t length)
+{
+	using namespace boost::asio::detail;
+	result res = { 0, 0, false };
+	if (_nonBlocking)
+	{
+		socket_ops::buf buf;
+		socket_ops::init_buf(buf, buff, length);
+		boost::system::error_code ec;
+		signed_size_type bytes = socket_ops::send(_socket.native_handle(), &buf, 1, 0, ec);
+		if (bytes >= 0 && !ec)
+		{
+			res.ok = true;
+			res.s = (size_t)bytes;
+		}
+		else
+		{
+			res.code = ec.value();
+		}
+	}
+	else
+	{
+		res.code = boost::asio::error::would_block;
+	}
+	return res;
+}
+
+tcp_socket::result tcp_socket::try_read_same(void* buff, size_t length)
+{
+	using namespace boost::asio::detail;
+	result res = { 0, 0, false };
+	if (_nonBlocking)
+	{
+		socket_ops::buf buf;
+		socket_ops::init_buf(buf, buff, length);
+		boost::system::error_code ec;
+		signed_size_type bytes = socket_ops::recv(_socket.native_handle(), &buf, 1, 0, ec);
+		if (bytes >= 0 && !ec)
+		{
+			res.ok = true;
+			res.s = (size_t)bytes;
+		}
+		else
+		{
+			res.code = ec.value();
+		}
+	}
+	else
+	{
+		res.code = boost::asio::error::would_block;
+	}
+	return res;
+}
+
+bool tcp_socket::probe_idle()
+{
+	using namespace boost::asio::detail;
+	if (!is_open())
+	{
+		return false;
+	}
+	if (!_nonBlocking)
+	{
+		return true;
+	}
+	char c;
+	socket_ops::buf buf;
+	socket_ops::init_buf(buf, &c, 1);
+	boost::system::error_code ec;
+	signed_size_type bytes = socket_ops::recv(_socket.native_handle(), &buf, 1, MSG_PEEK, ec);
+	//0为对端已关闭，大于0为有残留数据，都不能再复用
+	return bytes < 0 && (boost::asio::error::would_block == ec || boost::asio::error::try_again == ec);
+}
+
+tcp_socket::result tcp_socket::try_mwrite_same(const void* const* buffs, const size_t* lengths, size_t count, size_t* lastBytes)
+{
+#ifdef ENABLE_SCK_MULTI_IO
+	if (!lastBytes)
+	{
+		return _try_mwrite_same(buffs, lengths, count);
+	}
+	result res = { 0, 0, false };
+	size_t i = 0;
+	while (true)
+	{
+		struct iovec msgs[32];
+		struct mmsghdr mhdr[32];
+		size_t ct = 0;
+		for (; ct < fixed_array_length(msgs); ct++)
+		{
+			size_t k = i*fixed_array_length(msgs) + ct;
+			if (k >= count)
+			{
+				break;
+			}
+			msgs[ct].iov_base = (void*)buffs[k];
+			msgs[ct].iov_len = lengths[k];
+			memset(&mhdr[ct], 0, sizeof(mhdr[ct]));
+			mhdr[ct].msg_hdr.msg_iov = &msgs[ct];
+			mhdr[ct].msg_hdr.msg_iovlen = 1;
 		}
 		if (!ct)
 		{
@@ -820,7 +1460,7 @@ bool tcp_socket::init_send_file(HANDLE hFile, unsigned long long* offset, size_t
 //////////////////////////////////////////////////////////////////////////
 
 tcp_acceptor::tcp_acceptor(io_engine& ios)
-:_ios(&ios), _nonBlocking(false)
+:_ios(&ios), _deadline(NULL), _nonBlocking(false)
 #ifdef ENABLE_ASIO_PRE_OP
 , _preOption(false)
 #endif
@@ -829,6 +1469,7 @@ tcp_acceptor::tcp_acceptor(io_engine& ios)
 tcp_acceptor::~tcp_acceptor()
 {
 	assert(!is_open());
+	set_deadline_list(NULL);
 }
 
 tcp_socket::result tcp_acceptor::open(const char* ip, unsigned short port)
@@ -890,6 +1531,34 @@ tcp_socket::result tcp_acceptor::open_v6(unsigned short port)
 	return tcp_socket::result{ 0, 0, false };
 }
 
+tcp_socket::result tcp_acceptor::open_reuse_port(const boost::asio::ip::tcp::endpoint& endPoint)
+{
+	if (!_acceptor.has())
+	{
+		try
+		{
+			_acceptor.create(*_ios);
+			_acceptor->open(endPoint.protocol());
+#ifdef SO_REUSEPORT
+			_acceptor->set_option(boost::asio::socket_base::reuse_address(true));
+			_acceptor->set_option(boost::asio::detail::socket_option::boolean<SOL_SOCKET, SO_REUSEPORT>(true));
+#elif (defined SO_EXCLUSIVEADDRUSE)
+			_acceptor->set_option(boost::asio::detail::socket_option::boolean<SOL_SOCKET, SO_EXCLUSIVEADDRUSE>(true));
+#endif
+			_acceptor->bind(endPoint);
+			_acceptor->listen();
+			set_internal_non_blocking();
+			return tcp_socket::result{ 0, 0, true };
+		}
+		catch (const boost::system::system_error& se)
+		{
+			close();
+			return tcp_socket::result{ 0, se.code().value(), !se.code() };
+		}
+	}
+	return tcp_socket::result{ 0, 0, false };
+}
+
 tcp_socket::result tcp_acceptor::assign(boost::asio::detail::socket_type accFd)
 {
 	try
@@ -964,142 +1633,1023 @@ tcp_socket::result tcp_acceptor::close()
 	return tcp_socket::result{ 0, 0, false };
 }
 
-bool tcp_acceptor::is_open()
+bool tcp_acceptor::is_open()
+{
+	if (_acceptor.has())
+	{
+		return _acceptor->is_open();
+	}
+	return false;
+}
+
+void tcp_acceptor::swap(tcp_acceptor& other)
+{
+	if (this == &other)
+	{
+		return;
+	}
+	if (other._acceptor.has() && _acceptor.has())
+	{
+		boost::asio::ip::tcp::acceptor tAcc(std::move(_acceptor.get()));
+		_acceptor.get() = std::move(other._acceptor.get());
+		other._acceptor.get() = std::move(tAcc);
+	}
+	else if (other._acceptor.has())
+	{
+		_acceptor.create(std::move(other._acceptor.get()));
+		other.close();
+	}
+	else if (_acceptor.has())
+	{
+		other._acceptor.create(std::move(_acceptor.get()));
+		close();
+	}
+	std::swap(_nonBlocking, other._nonBlocking);
+	std::swap(_ios, other._ios);
+#ifdef ENABLE_ASIO_PRE_OP
+	std::swap(_preOption, other._preOption);
+#endif
+}
+
+void tcp_acceptor::pre_option()
+{
+#ifdef ENABLE_ASIO_PRE_OP
+	_preOption = true;
+#endif
+}
+
+bool tcp_acceptor::is_pre_option()
+{
+#ifdef ENABLE_ASIO_PRE_OP
+	return _preOption;
+#else
+	return false;
+#endif
+}
+
+tcp_socket::result tcp_acceptor::accept(my_actor* host, tcp_socket& socket)
+{
+	my_actor::quit_guard qg(host);
+	return host->trig<tcp_socket::result>([&](trig_once_notifer<tcp_socket::result>&& h)
+	{
+		async_accept(socket, std::move(h));
+	});
+}
+
+tcp_socket::result tcp_acceptor::timed_accept(my_actor* host, int ms, tcp_socket& socket)
+{
+	bool overtime = false;
+	tcp_socket::result res = { 0, 0, false };
+	my_actor::quit_guard qg(host);
+	if (ms > 0 && _deadline)
+	{
+		socket_deadline_list::begin(_deadline, socket_deadline_list::other_slot, ms);
+		async_accept(socket, host->make_asio_context(res));
+		return socket_deadline_list::end(_deadline, socket_deadline_list::other_slot, res);
+	}
+	else if (ms > 0)
+	{
+		async_accept(socket, host->make_asio_timed_context(ms, [&]()
+		{
+			overtime = true;
+			cancel();
+		}, res));
+	}
+	else
+	{
+		async_accept(socket, host->make_asio_context(res));
+	}
+	return (overtime && !res.ok) ? tcp_socket::result{ res.s, boost::asio::error::timed_out, false } : res;
+}
+
+tcp_socket::result tcp_acceptor::try_accept(tcp_socket& socket)
+{
+	using namespace boost::asio::detail;
+	tcp_socket::result res = { 0, 0, false };
+	if (_nonBlocking)
+	{
+		boost::asio::ip::tcp::endpoint remoteEndpoint;
+		std::size_t addrLen = remoteEndpoint.capacity();
+		boost::system::error_code ec;
+		socket_type newSck = socket_ops::accept(_acceptor->native_handle(), remoteEndpoint.data(), &addrLen, ec);
+		if (invalid_socket != newSck)
+		{
+			if (!ec)
+			{
+				remoteEndpoint.resize(addrLen);
+				socket._socket.assign(remoteEndpoint.protocol(), newSck, ec);
+			}
+			if (ec)
+			{
+				res.code = ec.value();
+				socket_ops::state_type state = socket_ops::stream_oriented;
+				socket_ops::close(newSck, state, true, ec);
+			}
+			else
+			{
+				socket.set_internal_non_blocking();
+				res.ok = true;
+				res.s = 1;
+			}
+		}
+		else
+		{
+			res.code = ec.value();
+		}
+	}
+	else
+	{
+		res.code = boost::asio::error::would_block;
+	}
+	return res;
+}
+
+void tcp_acceptor::set_deadline_list(socket_deadline_list* deadlines)
+{
+	if (_deadline && _deadline->_list != deadlines)
+	{
+		_deadline->_list->detach(_deadline);
+		_deadline = NULL;
+	}
+	if (deadlines && !_deadline)
+	{
+		_deadline = deadlines->attach(this, &tcp_acceptor::deadline_cancel);
+	}
+}
+
+void tcp_acceptor::deadline_cancel(void* owner, int)
+{
+	((tcp_acceptor*)owner)->cancel();
+}
+
+void tcp_acceptor::set_internal_non_blocking()
+{
+	boost::system::error_code ec;
+	using namespace boost::asio::detail;
+	socket_ops::state_type state = socket_ops::user_set_non_blocking;
+	_nonBlocking = socket_ops::set_internal_non_blocking(_acceptor->native_handle(), state, true, ec);
+}
+//////////////////////////////////////////////////////////////////////////
+
+tcp_shard_acceptor::tcp_shard_acceptor(io_engine& ios)
+:_ios(&ios) {}
+
+tcp_shard_acceptor::~tcp_shard_acceptor()
+{
+	assert(_shards.empty());
+}
+
+tcp_socket::result tcp_shard_acceptor::open(const boost::asio::ip::tcp::endpoint& endPoint, accept_handler h, size_t shards, size_t batch)
+{
+	assert(h);
+	if (!_shards.empty())
+	{
+		return tcp_socket::result{ 0, 0, false };
+	}
+#ifdef SO_REUSEPORT
+	shards = shards ? shards : _ios->ioThreads();
+#else
+	shards = 1;
+#endif
+	_shards.reserve(shards);
+	for (size_t i = 0; i < shards; i++)
+	{
+		_shards.push_back(std::unique_ptr<shard>(new shard(*_ios)));
+		tcp_socket::result res = _shards.back()->_acceptor.open_reuse_port(endPoint);
+		if (!res.ok)
+		{
+			while (!_shards.empty())
+			{
+				_shards.back()->_acceptor.close();
+				_shards.pop_back();
+			}
+			return tcp_socket::result{ 0, res.code, false };
+		}
+	}
+	for (size_t i = 0; i < shards; i++)
+	{
+		shard& sd = *_shards[i];
+		sd._actor = my_actor::create(sd._strand, std::bind([&sd, batch](my_actor* self, accept_handler& h)
+		{
+			shard_run(self, sd, h, batch);
+		}, __1, h));
+		sd._actor->run();
+	}
+	return tcp_socket::result{ shards, 0, true };
+}
+
+tcp_socket::result tcp_shard_acceptor::open(const char* ip, unsigned short port, accept_handler h, size_t shards, size_t batch)
+{
+	return open(tcp_socket::make_endpoint(ip, port), std::move(h), shards, batch);
+}
+
+tcp_socket::result tcp_shard_acceptor::open_v4(unsigned short port, accept_handler h, size_t shards, size_t batch)
+{
+	return open(boost::asio::ip::tcp::endpoint(boost::asio::ip::address_v4(), port), std::move(h), shards, batch);
+}
+
+void tcp_shard_acceptor::close(my_actor* host)
+{
+	my_actor::quit_guard qg(host);
+	for (size_t i = 0; i < _shards.size(); i++)
+	{
+		shard& sd = *_shards[i];
+		host->send(sd._strand, [&sd]
+		{
+			sd._acceptor.close();
+		});
+		host->actor_wait_quit(sd._actor);
+	}
+	_shards.clear();
+}
+
+size_t tcp_shard_acceptor::shards()
+{
+	return _shards.size();
+}
+
+bool tcp_shard_acceptor::is_open()
+{
+	return !_shards.empty();
+}
+
+void tcp_shard_acceptor::shard_run(my_actor* host, shard& sd, const accept_handler& h, size_t batch)
+{
+	std::shared_ptr<tcp_socket> socket;
+	while (sd._acceptor.is_open())
+	{
+		if (!socket)
+		{
+			socket.reset(new tcp_socket(host->self_io_engine()));
+		}
+		if (!sd._acceptor.accept(host, *socket).ok)
+		{
+			if (sd._acceptor.is_open())
+			{//文件句柄耗尽等错误，稍后重试
+				host->sleep(1);
+			}
+			continue;
+		}
+		h(sd._strand, std::move(socket));
+		socket.reset();
+		//侦听器已就绪，非阻塞地取出其余已完成握手的连接，避免每个连接都经过一次异步回调
+		for (size_t i = 1; i < batch; i++)
+		{
+			socket.reset(new tcp_socket(host->self_io_engine()));
+			if (!sd._acceptor.try_accept(*socket).ok)
+			{
+				break;
+			}
+			h(sd._strand, std::move(socket));
+			socket.reset();
+		}
+	}
+}
+//////////////////////////////////////////////////////////////////////////
+
+tcp_frame_reader::tcp_frame_reader(tcp_socket& socket, size_t bufferSize, size_t headBytes, bool bigEndian, size_t maxFrame)
+:_socket(&socket), _buffer(bufferSize > headBytes ? bufferSize : 4096), _begin(0), _end(0), _pending(0), _scanned(0), _readCount(0),
+_maxFrame(maxFrame), _headBytes((unsigned char)headBytes), _bigEndian(bigEndian)
+{
+	assert(1 == headBytes || 2 == headBytes || 4 == headBytes || 8 == headBytes);
+}
+
+tcp_frame_reader::result tcp_frame_reader::read_frame(my_actor* host, const char*& frame, size_t& length)
+{
+	return timed_read_frame(host, -1, frame, length);
+}
+
+tcp_frame_reader::result tcp_frame_reader::timed_read_frame(my_actor* host, int ms, const char*& frame, size_t& length)
+{
+	drop_pending();
+	const long long deadline = ms >= 0 ? get_tick_us() + (long long)ms * 1000 : -1;
+	result res = fill(host, deadline, _headBytes);
+	if (!res.ok)
+	{
+		return res;
+	}
+	//长度来自对端，8字节头时_headBytes + length可能回绕
+	const unsigned long long frameLength = frame_length(&_buffer[_begin]);
+	if (frameLength > (unsigned long long)((size_t)-1 - _headBytes) || (_maxFrame && frameLength > _maxFrame))
+	{
+		return result{ 0, boost::asio::error::message_size, false };
+	}
+	length = (size_t)frameLength;
+	res = fill(host, deadline, _headBytes + length);
+	if (!res.ok)
+	{
+		return res;
+	}
+	frame = &_buffer[0] + _begin + _headBytes;
+	_pending = _headBytes + length;
+	return result{ length, 0, true };
+}
+
+tcp_frame_reader::result tcp_frame_reader::read_until(my_actor* host, const char* delim, size_t delimLength, const char*& data, size_t& length)
+{
+	return timed_read_until(host, -1, delim, delimLength, data, length);
+}
+
+tcp_frame_reader::result tcp_frame_reader::timed_read_until(my_actor* host, int ms, const char* delim, size_t delimLength, const char*& data, size_t& length)
+{
+	assert(delimLength);
+	drop_pending();
+	const long long deadline = ms >= 0 ? get_tick_us() + (long long)ms * 1000 : -1;
+	while (true)
+	{
+		//只搜索新到达的数据，避免重复扫描
+		const size_t from = _scanned > delimLength ? _scanned - delimLength + 1 : 0;
+		const char* const first = &_buffer[0] + _begin;
+		const char* const last = &_buffer[0] + _end;
+		const char* const it = std::search(first + from, last, delim, delim + delimLength);
+		if (last != it)
+		{
+			data = first;
+			length = (it - first) + delimLength;
+			_pending = length;
+			_scanned = 0;
+			return result{ length, 0, true };
+		}
+		_scanned = _end - _begin;
+		if (_maxFrame && _scanned >= _maxFrame)
+		{
+			return result{ 0, boost::asio::error::message_size, false };
+		}
+		result res = fill(host, deadline, _scanned + 1);
+		if (!res.ok)
+		{
+			return res;
+		}
+	}
+}
+
+tcp_frame_reader::result tcp_frame_reader::peek(my_actor* host, size_t length, const char*& data)
+{
+	return timed_peek(host, -1, length, data);
+}
+
+tcp_frame_reader::result tcp_frame_reader::timed_peek(my_actor* host, int ms, size_t length, const char*& data)
+{
+	drop_pending();
+	result res = fill(host, ms >= 0 ? get_tick_us() + (long long)ms * 1000 : -1, length);
+	if (res.ok)
+	{
+		data = &_buffer[0] + _begin;
+		res.s = length;
+	}
+	return res;
+}
+
+void tcp_frame_reader::consume(size_t length)
+{
+	drop_pending();
+	assert(length <= _end - _begin);
+	_begin += length;
+	_scanned = 0;
+	if (_begin == _end)
+	{
+		_begin = 0;
+		_end = 0;
+	}
+}
+
+void tcp_frame_reader::drop_pending()
+{
+	if (_pending)
+	{
+		_begin += _pending;
+		_pending = 0;
+		_scanned = 0;
+		if (_begin == _end)
+		{
+			_begin = 0;
+			_end = 0;
+		}
+	}
+}
+
+size_t tcp_frame_reader::available()
+{
+	return _end - _begin - _pending;
+}
+
+size_t tcp_frame_reader::read_count()
+{
+	return _readCount;
+}
+
+tcp_frame_reader::result tcp_frame_reader::fill(my_actor* host, long long deadline, size_t length)
+{
+	while (_end - _begin < length)
+	{
+		if (_begin + length > _buffer.size())
+		{
+			//尾部空间不足，已缓存数据移到头部，仍不够时扩展缓存
+			if (_begin)
+			{
+				memmove(&_buffer[0], &_buffer[_begin], _end - _begin);
+				_end -= _begin;
+				_begin = 0;
+			}
+			if (length > _buffer.size())
+			{
+				if (_maxFrame && length > _headBytes && length - _headBytes > _maxFrame)
+				{
+					return result{ 0, boost::asio::error::message_size, false };
+				}
+				_buffer.resize(length > 2 * _buffer.size() ? length : 2 * _buffer.size());
+			}
+		}
+		result res;
+		_readCount++;
+		if (deadline >= 0)
+		{
+			const long long remain = deadline - get_tick_us();
+			if (remain <= 0)
+			{
+				return result{ 0, boost::asio::error::timed_out, false };
+			}
+			res = _socket->timed_read_some(host, (int)((remain + 999) / 1000), &_buffer[_end], _buffer.size() - _end);
+		}
+		else
+		{
+			res = _socket->read_some(host, &_buffer[_end], _buffer.size() - _end);
+		}
+		if (!res.ok)
+		{
+			return res;
+		}
+		_end += res.s;
+	}
+	return result{ 0, 0, true };
+}
+
+unsigned long long tcp_frame_reader::frame_length(const char* head)
+{
+	unsigned long long length = 0;
+	for (size_t i = 0; i < _headBytes; i++)
+	{
+		const unsigned char b = (unsigned char)head[_bigEndian ? i : _headBytes - i - 1];
+		length = (length << 8) | b;
+	}
+	return length;
+}
+//////////////////////////////////////////////////////////////////////////
+
+tcp_cork_writer::tcp_cork_writer(const shared_strand& strand, tcp_socket& socket, size_t flushBytes, int delayUs, size_t maxBytes)
+:_strand(strand), _socket(&socket), _self(new tcp_cork_writer*(this)), _writeCount(0),
+_flushBytes(flushBytes), _maxBytes(maxBytes > flushBytes ? maxBytes : flushBytes), _delayUs(delayUs), _back(0), _sending(false), _scheduled(false)
+{
+	_error = result{ 0, 0, true };
+	if (_delayUs > 0)
+	{
+		_timer = _strand->make_timer();
+	}
+}
+
+tcp_cork_writer::~tcp_cork_writer()
+{
+	assert(!_sending && _waiters.empty());
+	*_self = NULL;
+	if (_timer)
+	{
+		_timer->cancel();
+	}
+}
+
+tcp_cork_writer::result tcp_cork_writer::write(my_actor* host, const void* buff, size_t length, bool flushNow)
+{
+	assert(host->self_strand() == _strand);
+	while (_error.ok && !_queue[_back].empty() && _queue[_back].size() + length > _maxBytes)
+	{
+		kick();
+		if (!_queue[_back].empty())
+		{
+			wait(host);
+		}
+	}
+	if (!_error.ok)
+	{
+		return result{ 0, _error.code, false };
+	}
+	_queue[_back].insert(_queue[_back].end(), (const char*)buff, (const char*)buff + length);
+	if (flushNow || _queue[_back].size() >= _flushBytes)
+	{
+		kick();
+	}
+	else
+	{
+		schedule();
+	}
+	return result{ length, 0, true };
+}
+
+tcp_cork_writer::result tcp_cork_writer::flush(my_actor* host)
+{
+	assert(host->self_strand() == _strand);
+	while (_error.ok && (_sending || !_queue[_back].empty()))
+	{
+		kick();
+		wait(host);
+	}
+	return result{ 0, _error.code, _error.ok };
+}
+
+size_t tcp_cork_writer::pending()
+{
+	return _queue[_back].size() + (_sending ? _queue[!_back].size() : 0);
+}
+
+size_t tcp_cork_writer::write_count()
+{
+	return _writeCount;
+}
+
+void tcp_cork_writer::schedule()
+{
+	if (_scheduled || _sending)
+	{//发送完成后会继续发出已追加的数据
+		return;
+	}
+	_scheduled = true;
+	std::shared_ptr<tcp_cork_writer*> self = _self;
+	auto h = [self]()
+	{
+		if (*self)
+		{
+			(*self)->_scheduled = false;
+			(*self)->kick();
+		}
+	};
+	if (_timer)
+	{
+		_timer->utimeout(_delayUs, std::move(h));
+	}
+	else
+	{
+		_strand->post(std::move(h));
+	}
+}
+
+void tcp_cork_writer::kick()
+{
+	if (_sending || !_error.ok || _queue[_back].empty())
+	{
+		return;
+	}
+	std::vector<char>& front = _queue[_back];
+	_back = !_back;
+	_sending = true;
+	_writeCount++;
+	std::shared_ptr<tcp_cork_writer*> self = _self;
+	shared_strand strand = _strand;
+	_socket->async_write(&front[0], front.size(), [self, strand](const result& res)
+	{
+		strand->distribute([self, res]()
+		{
+			if (*self)
+			{
+				(*self)->on_sent(res);
+			}
+		});
+	});
+}
+
+void tcp_cork_writer::on_sent(const result& res)
+{
+	_sending = false;
+	_queue[!_back].clear();
+	if (!res.ok)
+	{
+		_error = res;
+	}
+	else if (!_scheduled)
+	{//发送期间追加的数据
+		kick();
+	}
+	std::vector<trig_once_notifer<> > waiters;
+	waiters.swap(_waiters);
+	for (size_t i = 0; i < waiters.size(); i++)
+	{
+		waiters[i]();
+	}
+}
+
+void tcp_cork_writer::wait(my_actor* host)
+{
+	if (!_sending)
+	{
+		return;
+	}
+	my_actor::quit_guard qg(host);
+	host->trig([this](trig_once_notifer<>&& ntf)
+	{
+		_waiters.push_back(std::move(ntf));
+	});
+}
+//////////////////////////////////////////////////////////////////////////
+
+tcp_connection_pool::tcp_connection_pool(io_engine& ios, size_t maxIdle, int maxIdleMs, int connectMs)
+:_ios(&ios), _idleCount(0), _connectCount(0), _maxIdle(maxIdle), _maxIdleMs(maxIdleMs), _connectMs(connectMs) {}
+
+tcp_connection_pool::~tcp_connection_pool()
+{
+	clear();
+}
+
+tcp_socket::result tcp_connection_pool::warm_up(my_actor* host, const boost::asio::ip::tcp::endpoint& remoteEndpoint, size_t count)
+{
+	{
+		std::lock_guard<std::mutex> lg(_mutex);
+		const size_t idles = _idles[remoteEndpoint].size();
+		count = idles < _maxIdle ? std::min(count, _maxIdle - idles) : 0;
+		_connectCount += count;
+	}
+	if (!count)
+	{
+		return tcp_socket::result{ 0, 0, true };
+	}
+	std::vector<std::shared_ptr<tcp_socket> > sockets(count);
+	std::vector<tcp_socket*> socketPtrs(count);
+	for (size_t i = 0; i < count; i++)
+	{
+		sockets[i].reset(new tcp_socket(*_ios));
+		socketPtrs[i] = sockets[i].get();
+	}
+	std::vector<tcp_socket::result> results(count);
+	tcp_socket::result res = tcp_socket::timed_connect_n(host, _connectMs, remoteEndpoint, &socketPtrs[0], count, &results[0]);
+	for (size_t i = 0; i < count; i++)
+	{
+		if (results[i].ok)
+		{
+			checkin(remoteEndpoint, std::move(sockets[i]));
+		}
+		else
+		{
+			sockets[i]->close();
+		}
+	}
+	return res;
+}
+
+tcp_socket::result tcp_connection_pool::checkout(my_actor* host, const boost::asio::ip::tcp::endpoint& remoteEndpoint, std::shared_ptr<tcp_socket>& socket)
+{
+	const long long now = get_tick_us();
+	while (true)
+	{
+		idle_socket idle;
+		{
+			std::lock_guard<std::mutex> lg(_mutex);
+			auto it = _idles.find(remoteEndpoint);
+			if (_idles.end() == it || it->second.empty())
+			{
+				break;
+			}
+			//后进先出，最近归还的连接最可能仍然可用
+			idle = std::move(it->second.back());
+			it->second.pop_back();
+			_idleCount--;
+		}
+		if (now - idle._tick < (long long)_maxIdleMs * 1000 && idle._socket->probe_idle())
+		{
+			socket = std::move(idle._socket);
+			return tcp_socket::result{ 0, 0, true };
+		}
+		idle._socket->close();
+	}
+	{
+		std::lock_guard<std::mutex> lg(_mutex);
+		_connectCount++;
+	}
+	socket.reset(new tcp_socket(*_ios));
+	tcp_socket::result res = socket->timed_connect(host, _connectMs, remoteEndpoint);
+	if (!res.ok)
+	{
+		socket->close();
+		socket.reset();
+	}
+	return res;
+}
+
+void tcp_connection_pool::checkin(const boost::asio::ip::tcp::endpoint& remoteEndpoint, std::shared_ptr<tcp_socket>&& socket, bool reusable)
+{
+	if (!socket)
+	{
+		return;
+	}
+	std::vector<std::shared_ptr<tcp_socket> > closes;
+	if (reusable && socket->is_open())
+	{
+		const long long now = get_tick_us();
+		std::lock_guard<std::mutex> lg(_mutex);
+		std::vector<idle_socket>& idles = _idles[remoteEndpoint];
+		close_expired(idles, now, closes);
+		if (idles.size() < _maxIdle)
+		{
+			idles.push_back(idle_socket{ std::move(socket), now });
+			_idleCount++;
+		}
+	}
+	if (socket)
+	{
+		closes.push_back(std::move(socket));
+	}
+	for (size_t i = 0; i < closes.size(); i++)
+	{
+		closes[i]->close();
+	}
+}
+
+size_t tcp_connection_pool::shrink()
+{
+	std::vector<std::shared_ptr<tcp_socket> > closes;
+	{
+		const long long now = get_tick_us();
+		std::lock_guard<std::mutex> lg(_mutex);
+		for (auto it = _idles.begin(); it != _idles.end();)
+		{
+			close_expired(it->second, now, closes);
+			if (it->second.empty())
+			{
+				it = _idles.erase(it);
+			}
+			else
+			{
+				++it;
+			}
+		}
+	}
+	for (size_t i = 0; i < closes.size(); i++)
+	{
+		closes[i]->close();
+	}
+	return closes.size();
+}
+
+void tcp_connection_pool::clear()
+{
+	std::map<boost::asio::ip::tcp::endpoint, std::vector<idle_socket> > idles;
+	{
+		std::lock_guard<std::mutex> lg(_mutex);
+		idles.swap(_idles);
+		_idleCount = 0;
+	}
+	for (auto& group : idles)
+	{
+		for (size_t i = 0; i < group.second.size(); i++)
+		{
+			group.second[i]._socket->close();
+		}
+	}
+}
+
+size_t tcp_connection_pool::idle_count()
+{
+	std::lock_guard<std::mutex> lg(_mutex);
+	return _idleCount;
+}
+
+size_t tcp_connection_pool::connect_count()
+{
+	std::lock_guard<std::mutex> lg(_mutex);
+	return _connectCount;
+}
+
+void tcp_connection_pool::close_expired(std::vector<idle_socket>& idles, long long now, std::vector<std::shared_ptr<tcp_socket> >& closes)
+{
+	//按归还时间排列，过期的都在前面
+	size_t n = 0;
+	while (n < idles.size() && now - idles[n]._tick >= (long long)_maxIdleMs * 1000)
+	{
+		closes.push_back(std::move(idles[n]._socket));
+		n++;
+	}
+	if (n)
+	{
+		idles.erase(idles.begin(), idles.begin() + n);
+		_idleCount -= n;
+	}
+}
+//////////////////////////////////////////////////////////////////////////
+
+#ifdef __linux__
+tcp_splice_pipe::tcp_splice_pipe(size_t pipeSize)
+:_pipeSize(pipeSize), _buffered(0), _inBytes(0), _outBytes(0)
+{
+	_pipe[0] = -1;
+	_pipe[1] = -1;
+	open_pipe();
+}
+
+tcp_splice_pipe::~tcp_splice_pipe()
+{
+	close_pipe();
+}
+
+bool tcp_splice_pipe::is_open()
+{
+	return -1 != _pipe[0];
+}
+
+tcp_splice_pipe::result tcp_splice_pipe::relay(my_actor* host, tcp_socket& src, tcp_socket& dst, size_t length)
+{
+	return transfer(host, -1, &src, src._socket.native_handle(), NULL, &dst, dst._socket.native_handle(), NULL, length);
+}
+
+tcp_splice_pipe::result tcp_splice_pipe::timed_relay(my_actor* host, int ms, tcp_socket& src, tcp_socket& dst, size_t length)
+{
+	const long long deadline = ms >= 0 ? get_tick_us() + (long long)ms * 1000 : -1;
+	return transfer(host, deadline, &src, src._socket.native_handle(), NULL, &dst, dst._socket.native_handle(), NULL, length);
+}
+
+tcp_splice_pipe::result tcp_splice_pipe::send_file(my_actor* host, int fd, unsigned long long* offset, size_t length, tcp_socket& dst)
+{
+	return transfer(host, -1, NULL, fd, offset, &dst, dst._socket.native_handle(), NULL, length);
+}
+
+tcp_splice_pipe::result tcp_splice_pipe::timed_send_file(my_actor* host, int ms, int fd, unsigned long long* offset, size_t length, tcp_socket& dst)
 {
-	if (_acceptor.has())
-	{
-		return _acceptor->is_open();
-	}
-	return false;
+	const long long deadline = ms >= 0 ? get_tick_us() + (long long)ms * 1000 : -1;
+	return transfer(host, deadline, NULL, fd, offset, &dst, dst._socket.native_handle(), NULL, length);
 }
 
-void tcp_acceptor::swap(tcp_acceptor& other)
+tcp_splice_pipe::result tcp_splice_pipe::recv_file(my_actor* host, tcp_socket& src, int fd, unsigned long long* offset, size_t length)
 {
-	if (this == &other)
-	{
-		return;
-	}
-	if (other._acceptor.has() && _acceptor.has())
-	{
-		boost::asio::ip::tcp::acceptor tAcc(std::move(_acceptor.get()));
-		_acceptor.get() = std::move(other._acceptor.get());
-		other._acceptor.get() = std::move(tAcc);
-	}
-	else if (other._acceptor.has())
-	{
-		_acceptor.create(std::move(other._acceptor.get()));
-		other.close();
-	}
-	else if (_acceptor.has())
-	{
-		other._acceptor.create(std::move(_acceptor.get()));
-		close();
-	}
-	std::swap(_nonBlocking, other._nonBlocking);
-	std::swap(_ios, other._ios);
-#ifdef ENABLE_ASIO_PRE_OP
-	std::swap(_preOption, other._preOption);
-#endif
+	return transfer(host, -1, &src, src._socket.native_handle(), NULL, NULL, fd, offset, length);
 }
 
-void tcp_acceptor::pre_option()
+tcp_splice_pipe::result tcp_splice_pipe::timed_recv_file(my_actor* host, int ms, tcp_socket& src, int fd, unsigned long long* offset, size_t length)
 {
-#ifdef ENABLE_ASIO_PRE_OP
-	_preOption = true;
-#endif
+	const long long deadline = ms >= 0 ? get_tick_us() + (long long)ms * 1000 : -1;
+	return transfer(host, deadline, &src, src._socket.native_handle(), NULL, NULL, fd, offset, length);
 }
 
-bool tcp_acceptor::is_pre_option()
+unsigned long long tcp_splice_pipe::in_bytes()
 {
-#ifdef ENABLE_ASIO_PRE_OP
-	return _preOption;
-#else
-	return false;
-#endif
+	return _inBytes;
 }
 
-tcp_socket::result tcp_acceptor::accept(my_actor* host, tcp_socket& socket)
+unsigned long long tcp_splice_pipe::out_bytes()
 {
-	my_actor::quit_guard qg(host);
-	return host->trig<tcp_socket::result>([&](trig_once_notifer<tcp_socket::result>&& h)
-	{
-		async_accept(socket, std::move(h));
-	});
+	return _outBytes;
 }
 
-tcp_socket::result tcp_acceptor::timed_accept(my_actor* host, int ms, tcp_socket& socket)
+void tcp_splice_pipe::reset_bytes()
 {
-	bool overtime = false;
-	tcp_socket::result res = { 0, 0, false };
-	my_actor::quit_guard qg(host);
-	if (ms > 0)
-	{
-		async_accept(socket, host->make_asio_timed_context(ms, [&]()
-		{
-			overtime = true;
-			cancel();
-		}, res));
-	}
-	else
-	{
-		async_accept(socket, host->make_asio_context(res));
-	}
-	return (overtime && !res.ok) ? tcp_socket::result{ res.s, boost::asio::error::timed_out, false } : res;
+	_inBytes = 0;
+	_outBytes = 0;
 }
 
-tcp_socket::result tcp_acceptor::try_accept(tcp_socket& socket)
+tcp_splice_pipe::result tcp_splice_pipe::transfer(my_actor* host, long long deadline, tcp_socket* srcSck, int srcFd, unsigned long long* srcOff,
+	tcp_socket* dstSck, int dstFd, unsigned long long* dstOff, size_t length)
 {
-	using namespace boost::asio::detail;
-	tcp_socket::result res = { 0, 0, false };
-	if (_nonBlocking)
+	result res = { 0, 0, false };
+	if (_buffered)
+	{//上次失败残留在管道中的数据属于之前的目标，丢弃
+		close_pipe();
+	}
+	if (!is_open() && !open_pipe())
 	{
-		boost::asio::ip::tcp::endpoint remoteEndpoint;
-		std::size_t addrLen = remoteEndpoint.capacity();
-		boost::system::error_code ec;
-		socket_type newSck = socket_ops::accept(_acceptor->native_handle(), remoteEndpoint.data(), &addrLen, ec);
-		if (invalid_socket != newSck)
+		res.code = errno;
+		return res;
+	}
+	loff_t srcPos = srcOff ? (loff_t)*srcOff : 0;
+	loff_t dstPos = dstOff ? (loff_t)*dstOff : 0;
+	bool eof = false;
+	while (true)
+	{
+		bool progress = false;
+		size_t want = eof ? 0 : _pipeSize - _buffered;
+		if (length && want > length - res.s - _buffered)
 		{
-			if (!ec)
+			want = length - res.s - _buffered;
+		}
+		if (want)
+		{
+			const ssize_t n = ::splice(srcFd, srcOff ? &srcPos : NULL, _pipe[1], NULL, want, SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+			if (n > 0)
 			{
-				remoteEndpoint.resize(addrLen);
-				socket._socket.assign(remoteEndpoint.protocol(), newSck, ec);
+				_buffered += n;
+				_inBytes += n;
+				progress = true;
 			}
-			if (ec)
+			else if (!n)
 			{
-				res.code = ec.value();
-				socket_ops::state_type state = socket_ops::stream_oriented;
-				socket_ops::close(newSck, state, true, ec);
+				eof = true;
 			}
-			else
+			else if (EINTR == errno)
 			{
-				socket.set_internal_non_blocking();
-				res.ok = true;
-				res.s = 1;
+				continue;
+			}
+			else if (EAGAIN != errno && EWOULDBLOCK != errno)
+			{
+				res.code = errno;
+				break;
 			}
 		}
-		else
+		if (_buffered)
 		{
-			res.code = ec.value();
+			const ssize_t n = ::splice(_pipe[0], NULL, dstFd, dstOff ? &dstPos : NULL, _buffered, SPLICE_F_MOVE | SPLICE_F_NONBLOCK | (want ? SPLICE_F_MORE : 0));
+			if (n > 0)
+			{
+				_buffered -= n;
+				_outBytes += n;
+				res.s += n;
+				progress = true;
+			}
+			else if (n < 0 && EINTR == errno)
+			{
+				continue;
+			}
+			else if (n < 0 && EAGAIN != errno && EWOULDBLOCK != errno)
+			{
+				res.code = errno;
+				break;
+			}
+		}
+		if (!_buffered && (eof || (length && length == res.s)))
+		{
+			if (eof && length && length != res.s)
+			{
+				res.code = boost::asio::error::eof;
+				break;
+			}
+			res.ok = true;
+			break;
+		}
+		if (!progress)
+		{
+			//管道中有数据时等待目标可写，否则等待源可读
+			tcp_socket* sck = _buffered ? dstSck : srcSck;
+			if (!sck)
+			{
+				res.code = boost::asio::error::would_block;
+				break;
+			}
+			int ms = 0;
+			if (deadline >= 0)
+			{
+				const long long remain = deadline - get_tick_us();
+				if (remain <= 0)
+				{
+					res.code = boost::asio::error::timed_out;
+					break;
+				}
+				ms = (int)((remain + 999) / 1000);
+			}
+			result wr = sck->wait_ready(host, ms, 0 != _buffered);
+			if (!wr.ok)
+			{
+				res.code = wr.code;
+				break;
+			}
 		}
 	}
-	else
+	if (srcOff)
 	{
-		res.code = boost::asio::error::would_block;
+		*srcOff = (unsigned long long)srcPos;
+	}
+	if (dstOff)
+	{
+		*dstOff = (unsigned long long)dstPos;
 	}
 	return res;
 }
 
-void tcp_acceptor::set_internal_non_blocking()
+bool tcp_splice_pipe::open_pipe()
 {
-	boost::system::error_code ec;
-	using namespace boost::asio::detail;
-	socket_ops::state_type state = socket_ops::user_set_non_blocking;
-	_nonBlocking = socket_ops::set_internal_non_blocking(_acceptor->native_handle(), state, true, ec);
+	if (0 != ::pipe2(_pipe, O_NONBLOCK | O_CLOEXEC))
+	{
+		_pipe[0] = -1;
+		_pipe[1] = -1;
+		return false;
+	}
+	if (_pipeSize)
+	{
+		::fcntl(_pipe[1], F_SETPIPE_SZ, (int)_pipeSize);
+	}
+	const int pipeSize = ::fcntl(_pipe[1], F_GETPIPE_SZ);
+	_pipeSize = pipeSize > 0 ? (size_t)pipeSize : 64 * 1024;
+	_buffered = 0;
+	return true;
+}
+
+void tcp_splice_pipe::close_pipe()
+{
+	if (-1 != _pipe[0])
+	{
+		::close(_pipe[0]);
+		::close(_pipe[1]);
+		_pipe[0] = -1;
+		_pipe[1] = -1;
+	}
+	_buffered = 0;
 }
+#endif
 //////////////////////////////////////////////////////////////////////////
 
 udp_socket::udp_socket(io_engine& ios)
-:_socket(ios), _nonBlocking(false)
+:_socket(ios), _nonBlocking(false), _gso(false)
 #ifndef HAS_ASIO_CANCEL_IO
 , _holdRecv(false), _holdSend(false), _cancelRecv(false), _cancelSend(false)
 #endif
@@ -1212,6 +2762,8 @@ udp_socket::result udp_socket::close()
 	boost::system::error_code ec;
 	_socket.shutdown(boost::asio::ip::udp::socket::shutdown_both, ec);
 	_socket.close(ec);
+	_gro.reset();
+	_gso = false;
 	return result{ 0, ec.value(), !ec };
 }
 
@@ -1284,6 +2836,8 @@ void udp_socket::swap(udp_socket& other)
 	std::swap(_cancelSend, other._cancelSend);
 #endif
 	std::swap(_nonBlocking, other._nonBlocking);
+	_gro.swap(other._gro);
+	std::swap(_gso, other._gso);
 #ifdef ENABLE_ASIO_PRE_OP
 	std::swap(_preOption, other._preOption);
 #endif
@@ -1515,6 +3069,10 @@ udp_socket::result udp_socket::try_send(const void* buff, size_t length, int fla
 
 udp_socket::result udp_socket::try_msend(const void* const* buffs, const size_t* lengths, size_t count, size_t* bytes, int flags)
 {
+	if (_gso)
+	{
+		return _try_gso_msend(NULL, 0, buffs, lengths, count, bytes, flags);
+	}
 #ifdef ENABLE_SCK_MULTI_IO
 	result res = { 0, 0, false };
 	size_t i = 0;
@@ -1614,6 +3172,10 @@ udp_socket::result udp_socket::try_msend(const void* const* buffs, const size_t*
 
 udp_socket::result udp_socket::try_msend_to(const boost::asio::ip::udp::endpoint* remoteEndpoints, const void* const* buffs, const size_t* lengths, size_t count, size_t* bytes, int flags)
 {
+	if (_gso)
+	{
+		return _try_gso_msend(remoteEndpoints, 1, buffs, lengths, count, bytes, flags);
+	}
 #ifdef ENABLE_SCK_MULTI_IO
 	result res = { 0, 0, false };
 	size_t i = 0;
@@ -1715,6 +3277,10 @@ udp_socket::result udp_socket::try_msend_to(const boost::asio::ip::udp::endpoint
 
 udp_socket::result udp_socket::try_msend_to(const boost::asio::ip::udp::endpoint& remoteEndpoint, const void* const* buffs, const size_t* lengths, size_t count, size_t* bytes, int flags)
 {
+	if (_gso)
+	{
+		return _try_gso_msend(&remoteEndpoint, 0, buffs, lengths, count, bytes, flags);
+	}
 #ifdef ENABLE_SCK_MULTI_IO
 	result res = { 0, 0, false };
 	size_t i = 0;
@@ -1875,6 +3441,10 @@ udp_socket::result udp_socket::try_receive(void* buff, size_t length, int flags)
 
 udp_socket::result udp_socket::try_mreceive(void* const* buffs, const size_t* lengths, size_t count, size_t* bytes, int flags)
 {
+	if (_gro)
+	{
+		return _try_gro_mreceive(NULL, buffs, lengths, count, bytes, flags);
+	}
 #ifdef ENABLE_SCK_MULTI_IO
 	result res = { 0, 0, false };
 	size_t i = 0;
@@ -1974,6 +3544,10 @@ udp_socket::result udp_socket::try_mreceive(void* const* buffs, const size_t* le
 
 udp_socket::result udp_socket::try_mreceive_from(boost::asio::ip::udp::endpoint* remoteEndpoints, void* const* buffs, const size_t* lengths, size_t count, size_t* bytes, int flags)
 {
+	if (_gro)
+	{
+		return _try_gro_mreceive(remoteEndpoints, buffs, lengths, count, bytes, flags);
+	}
 #ifdef ENABLE_SCK_MULTI_IO
 	result res = { 0, 0, false };
 	size_t i = 0;
@@ -2077,6 +3651,244 @@ udp_socket::result udp_socket::try_mreceive_from(boost::asio::ip::udp::endpoint*
 #endif
 }
 
+udp_socket::result udp_socket::gso(bool enable)
+{
+#ifdef HAS_UDP_GSO
+	_gso = enable;
+	return result{ 0, 0, true };
+#else
+	return result{ 0, boost::asio::error::operation_not_supported, false };
+#endif
+}
+
+udp_socket::result udp_socket::gro(bool enable)
+{
+#ifdef HAS_UDP_GRO
+	int val = enable ? 1 : 0;
+	if (::setsockopt(_socket.native_handle(), SOL_UDP, UDP_GRO, &val, sizeof(val)))
+	{
+		return result{ 0, errno, false };
+	}
+	if (!enable)
+	{
+		_gro.reset();
+	}
+	else if (!_gro)
+	{
+		_gro.reset(new gro_state);
+		_gro->_buff.resize(65536);
+		_gro->_pos = 0;
+		_gro->_segment = 0;
+		_gro->_remain = 0;
+	}
+	return result{ 0, 0, true };
+#else
+	return result{ 0, boost::asio::error::operation_not_supported, false };
+#endif
+}
+
+udp_socket::result udp_socket::_try_gso_msend(const boost::asio::ip::udp::endpoint* remoteEndpoints, size_t endpointStep, const void* const* buffs, const size_t* lengths, size_t count, size_t* bytes, int flags)
+{
+#ifdef HAS_UDP_GSO
+	result res = { 0, 0, false };
+	size_t i = 0;
+	size_t plainCount = 0;
+	while (i < count)
+	{
+		const boost::asio::ip::udp::endpoint* remoteEndpoint = remoteEndpoints ? remoteEndpoints + i*endpointStep : NULL;
+		const size_t segment = lengths[i];
+		size_t ct = 1;
+		if (plainCount)
+		{
+			plainCount--;
+		}
+		else if (segment)
+		{
+			//合并发往同一目标且长度相同的连续报文，更短的一条只能作为最后一段
+			size_t tot = segment;
+			while (i + ct < count && ct < UDP_GSO_MAX_SEGMENTS && lengths[i + ct] && lengths[i + ct] <= segment && tot + lengths[i + ct] <= UDP_GSO_MAX_BYTES
+				&& (!endpointStep || remoteEndpoints[(i + ct)*endpointStep] == *remoteEndpoint))
+			{
+				tot += lengths[i + ct];
+				if (lengths[i + ct++] != segment)
+				{
+					break;
+				}
+			}
+		}
+		struct iovec msgs[UDP_GSO_MAX_SEGMENTS];
+		for (size_t j = 0; j < ct; j++)
+		{
+			msgs[j].iov_base = (void*)buffs[i + j];
+			msgs[j].iov_len = lengths[i + j];
+		}
+		struct msghdr mhdr;
+		memset(&mhdr, 0, sizeof(mhdr));
+		mhdr.msg_iov = msgs;
+		mhdr.msg_iovlen = ct;
+		if (remoteEndpoint)
+		{
+			mhdr.msg_name = (void*)remoteEndpoint->data();
+			mhdr.msg_namelen = remoteEndpoint->size();
+		}
+		char control[CMSG_SPACE(sizeof(uint16_t))];
+		if (ct > 1)
+		{
+			memset(control, 0, sizeof(control));
+			mhdr.msg_control = control;
+			mhdr.msg_controllen = sizeof(control);
+			struct cmsghdr* cm = CMSG_FIRSTHDR(&mhdr);
+			cm->cmsg_level = SOL_UDP;
+			cm->cmsg_type = UDP_SEGMENT;
+			cm->cmsg_len = CMSG_LEN(sizeof(uint16_t));
+			*(uint16_t*)CMSG_DATA(cm) = (uint16_t)segment;
+		}
+		if (::sendmsg(_socket.native_handle(), &mhdr, flags | MSG_NOSIGNAL) >= 0)
+		{
+			//GSO报文整体发送成功或失败
+			res.s += ct;
+			if (bytes)
+			{
+				for (size_t j = 0; j < ct; j++)
+				{
+					bytes[i + j] = lengths[i + j];
+				}
+			}
+			i += ct;
+			continue;
+		}
+		const int err = errno;
+		if (EINTR == err)
+		{
+			continue;
+		}
+		if (ct > 1 && (EINVAL == err || EMSGSIZE == err))
+		{
+			//段大小超过路径MTU，这一组逐条发送
+			plainCount = ct;
+			continue;
+		}
+		if (ct > 1 && EIO == err)
+		{
+			//设备不支持分段卸载，关闭GSO，剩余部分按普通方式发送
+			_gso = false;
+			result tr = !remoteEndpoints ? try_msend(buffs + i, lengths + i, count - i, bytes ? bytes + i : NULL, flags)
+				: (endpointStep ? try_msend_to(remoteEndpoints + i, buffs + i, lengths + i, count - i, bytes ? bytes + i : NULL, flags)
+				: try_msend_to(*remoteEndpoints, buffs + i, lengths + i, count - i, bytes ? bytes + i : NULL, flags));
+			if (!tr.ok)
+			{
+				if (res.s && try_again(tr))
+				{
+					break;
+				}
+				res.code = tr.code;
+				return res;
+			}
+			res.s += tr.s;
+			break;
+		}
+		if (res.s && (EAGAIN == err || EWOULDBLOCK == err))
+		{
+			break;
+		}
+		res.code = err;
+		return res;
+	}
+	res.ok = true;
+	return res;
+#else
+	assert(false);
+	return result{ 0, boost::asio::error::operation_not_supported, false };
+#endif
+}
+
+udp_socket::result udp_socket::_try_gro_mreceive(boost::asio::ip::udp::endpoint* remoteEndpoints, void* const* buffs, const size_t* lengths, size_t count, size_t* bytes, int flags)
+{
+#ifdef HAS_UDP_GRO
+	result res = { 0, 0, false };
+	gro_state& gro = *_gro;
+	while (res.s < count)
+	{
+		if (!gro._remain)
+		{
+			struct iovec msg;
+			msg.iov_base = &gro._buff[0];
+			msg.iov_len = gro._buff.size();
+			char control[CMSG_SPACE(sizeof(int))];
+			struct msghdr mhdr;
+			memset(&mhdr, 0, sizeof(mhdr));
+			mhdr.msg_iov = &msg;
+			mhdr.msg_iovlen = 1;
+			mhdr.msg_name = gro._remoteEndpoint.data();
+			mhdr.msg_namelen = gro._remoteEndpoint.capacity();
+			mhdr.msg_control = control;
+			mhdr.msg_controllen = sizeof(control);
+			const ssize_t recvBytes = ::recvmsg(_socket.native_handle(), &mhdr, flags);
+			if (recvBytes < 0)
+			{
+				const int err = errno;
+				if (EINTR == err)
+				{
+					continue;
+				}
+				if (res.s && (EAGAIN == err || EWOULDBLOCK == err))
+				{
+					break;
+				}
+				res.code = err;
+				return res;
+			}
+			gro._remoteEndpoint.resize(mhdr.msg_namelen);
+			gro._pos = 0;
+			gro._remain = (size_t)recvBytes;
+			gro._segment = (size_t)recvBytes;
+			for (struct cmsghdr* cm = CMSG_FIRSTHDR(&mhdr); cm; cm = CMSG_NXTHDR(&mhdr, cm))
+			{
+				if (SOL_UDP == cm->cmsg_level && UDP_GRO == cm->cmsg_type)
+				{
+					gro._segment = (size_t)*(int*)CMSG_DATA(cm);
+					break;
+				}
+			}
+			if (!recvBytes)
+			{
+				//空报文
+				if (bytes)
+				{
+					bytes[res.s] = 0;
+				}
+				if (remoteEndpoints)
+				{
+					remoteEndpoints[res.s] = gro._remoteEndpoint;
+				}
+				res.s++;
+				continue;
+			}
+		}
+		//超过缓存长度的部分截断丢弃，与单条接收一致
+		const size_t segment = std::min(gro._segment, gro._remain);
+		const size_t length = std::min(segment, lengths[res.s]);
+		memcpy(buffs[res.s], &gro._buff[gro._pos], length);
+		if (bytes)
+		{
+			bytes[res.s] = length;
+		}
+		if (remoteEndpoints)
+		{
+			remoteEndpoints[res.s] = gro._remoteEndpoint;
+		}
+		gro._pos += segment;
+		gro._remain -= segment;
+		res.s++;
+	}
+	res.ok = true;
+	return res;
+#else
+	assert(false);
+	return result{ 0, boost::asio::error::operation_not_supported, false };
+#endif
+}
+
 udp_socket::result udp_socket::try_receive_from(void* buff, size_t length, int flags)
 {
 	return try_receive_from(_remoteSenderEndpoint, buff, length, flags);
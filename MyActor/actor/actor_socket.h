@@ -3,6 +3,8 @@
 
 #include <boost/asio/ip/tcp.hpp>
 #include <boost/asio/ip/udp.hpp>
+#include <map>
+#include <mutex>
 #include "my_actor.h"
 
 struct socket_result
@@ -12,13 +14,310 @@ struct socket_result
 	bool ok;///<是否成功
 };
 
+/*!
+@brief 引用计数的缓存链，拷贝时只增加各段引用计数，可直接通过消息传递，用于聚集写
+*/
+class buffer_chain
+{
+public:
+	buffer_chain()
+		:_size(0) {}
+
+	buffer_chain(const buffer_chain& s)
+		:_holders(s._holders), _buffers(s._buffers), _size(s._size) {}
+
+	buffer_chain(buffer_chain&& s)
+		:_holders(std::move(s._holders)), _buffers(std::move(s._buffers)), _size(s._size)
+	{
+		s._size = 0;
+	}
+
+	void operator=(const buffer_chain& s)
+	{
+		_holders = s._holders;
+		_buffers = s._buffers;
+		_size = s._size;
+	}
+
+	void operator=(buffer_chain&& s)
+	{
+		if (this != &s)
+		{
+			_holders = std::move(s._holders);
+			_buffers = std::move(s._buffers);
+			_size = s._size;
+			s._size = 0;
+		}
+	}
+public:
+	/*!
+	@brief 追加一段共享数据，不复制
+	*/
+	void append(const std::shared_ptr<const std::string>& seg)
+	{
+		append_ref(seg, seg->data(), seg->size());
+	}
+
+	/*!
+	@brief 追加一段数据，复制到新的共享段中
+	*/
+	void append(const void* buff, size_t length)
+	{
+		append(std::shared_ptr<const std::string>(new std::string((const char*)buff, length)));
+	}
+
+	void append(std::string&& data)
+	{
+		append(std::shared_ptr<const std::string>(new std::string(std::move(data))));
+	}
+
+	/*!
+	@brief 追加另一个缓存链的所有段，不复制
+	*/
+	void append(const buffer_chain& other)
+	{
+		_holders.insert(_holders.end(), other._holders.begin(), other._holders.end());
+		_buffers.insert(_buffers.end(), other._buffers.begin(), other._buffers.end());
+		_size += other._size;
+	}
+
+	/*!
+	@brief 追加一段由holder保证生命周期的数据，不复制
+	*/
+	template <typename T>
+	void append_ref(const std::shared_ptr<T>& holder, const void* buff, size_t length)
+	{
+		if (length)
+		{
+			_holders.push_back(holder);
+			_buffers.push_back(boost::asio::const_buffer(buff, length));
+			_size += length;
+		}
+	}
+
+	/*!
+	@brief 总字节数
+	*/
+	size_t size() const
+	{
+		return _size;
+	}
+
+	/*!
+	@brief 段数
+	*/
+	size_t count() const
+	{
+		return _buffers.size();
+	}
+
+	bool empty() const
+	{
+		return !_size;
+	}
+
+	/*!
+	@brief 各段缓存，用于 writev/async_writev
+	*/
+	const boost::asio::const_buffer* buffers() const
+	{
+		return _buffers.empty() ? NULL : &_buffers.front();
+	}
+
+	void clear()
+	{
+		_holders.clear();
+		_buffers.clear();
+		_size = 0;
+	}
+
+	void swap(buffer_chain& other)
+	{
+		_holders.swap(other._holders);
+		_buffers.swap(other._buffers);
+		std::swap(_size, other._size);
+	}
+private:
+	std::vector<std::shared_ptr<const void> > _holders;
+	std::vector<boost::asio::const_buffer> _buffers;
+	size_t _size;
+};
+
+/*!
+@brief 分散/聚集IO的进度，以首段偏移加剩余段的形式作为asio缓存序列
+*/
+template <typename Buffer>
+struct SocketIov_
+{
+	struct const_iterator
+	{
+		typedef std::forward_iterator_tag iterator_category;
+		typedef Buffer value_type;
+		typedef ptrdiff_t difference_type;
+		typedef const Buffer* pointer;
+		typedef Buffer reference;
+
+		const_iterator(const SocketIov_* iov, size_t i)
+			:_iov(iov), _i(i) {}
+
+		Buffer operator*() const
+		{
+			return _i == _iov->_index ? _iov->_buffs[_i] + _iov->_offset : _iov->_buffs[_i];
+		}
+
+		const_iterator& operator++()
+		{
+			_i++;
+			return *this;
+		}
+
+		const_iterator operator++(int)
+		{
+			const_iterator t(*this);
+			_i++;
+			return t;
+		}
+
+		bool operator==(const const_iterator& s) const
+		{
+			return _i == s._i;
+		}
+
+		bool operator!=(const const_iterator& s) const
+		{
+			return _i != s._i;
+		}
+
+		const SocketIov_* _iov;
+		size_t _i;
+	};
+	typedef Buffer value_type;
+
+	SocketIov_(const Buffer* buffs, size_t count)
+		:_buffs(buffs), _count(count), _index(0), _offset(0)
+	{
+		skip_empty();
+	}
+
+	const_iterator begin() const
+	{
+		return const_iterator(this, _index);
+	}
+
+	const_iterator end() const
+	{
+		return const_iterator(this, _count);
+	}
+
+	/*!
+	@brief 完成s字节后推进到未完成的位置
+	*/
+	void advance(size_t s)
+	{
+		while (s)
+		{
+			assert(_index < _count);
+			const size_t remain = boost::asio::buffer_size(_buffs[_index]) - _offset;
+			if (s < remain)
+			{
+				_offset += s;
+				return;
+			}
+			s -= remain;
+			_index++;
+			_offset = 0;
+		}
+		skip_empty();
+	}
+
+	bool completed() const
+	{
+		return _index == _count;
+	}
+
+	void skip_empty()
+	{
+		while (_index < _count && !boost::asio::buffer_size(_buffs[_index]))
+		{
+			_index++;
+		}
+	}
+
+	const Buffer* _buffs;
+	size_t _count;
+	size_t _index;
+	size_t _offset;
+};
+
+class tcp_socket;
 class tcp_acceptor;
 /*!
+@brief 粗粒度socket超时表，依附于一个strand，每个tick扫描一次登记的socket，取消已过期的连接/读/写/侦听操作；
+登记后timed_xxx操作只记录截止时间，不再为每次操作创建和取消定时器，超时误差在[0, 2*tick]内；
+登记的socket只能在该strand中使用和析构
+*/
+class socket_deadline_list
+{
+	friend tcp_socket;
+	friend tcp_acceptor;
+
+	enum { read_slot, write_slot, other_slot, slot_count };
+
+	struct node
+	{
+		socket_deadline_list* _list;
+		void* _owner;
+		void(*_cancel)(void* owner, int slot);
+		long long _deadline[slot_count];
+		bool _expired[slot_count];
+		size_t _index;
+	};
+public:
+	/*!
+	@param tickMs 扫描间隔
+	*/
+	socket_deadline_list(const shared_strand& strand, int tickMs = 100);
+	~socket_deadline_list();
+public:
+	/*!
+	@brief 依附的strand
+	*/
+	const shared_strand& self_strand();
+
+	/*!
+	@brief 登记的socket个数
+	*/
+	size_t size();
+
+	/*!
+	@brief 累计超时取消的操作个数
+	*/
+	size_t expired_count();
+private:
+	node* attach(void* owner, void(*cancel)(void* owner, int slot));
+	void detach(node* nd);
+	static void begin(node* nd, int slot, int ms);
+	static socket_result end(node* nd, int slot, const socket_result& res);
+	void tick();
+private:
+	shared_strand _strand;
+	async_timer _timer;
+	std::vector<node*> _nodes;
+	long long _now;
+	size_t _expiredCount;
+	const int _tickMs;
+	NONE_COPY(socket_deadline_list);
+};
+
+class tcp_shard_acceptor;
+class tcp_splice_pipe;
+/*!
 @brief tcp通信
 */
 class tcp_socket
 {
 	friend tcp_acceptor;
+	friend tcp_splice_pipe;
 public:
 	typedef socket_result result;
 private:
@@ -190,6 +489,176 @@ private:
 		COPY_CONSTRUCT5(async_write_op, _handler, _sck, _buffer, _currBytes, _totalBytes);
 	};
 
+	template <typename Handler>
+	struct async_readv_op
+	{
+		typedef RM_CREF(Handler) handler_type;
+
+		async_readv_op(Handler& handler, tcp_socket& sck, const SocketIov_<boost::asio::mutable_buffer>& iov)
+			:_handler(std::forward<Handler>(handler)), _sck(sck), _iov(iov), _currBytes(0) {}
+
+		void operator()(const boost::system::error_code& ec, size_t s)
+		{
+			while (_sck._holdRead)
+			{
+				run_thread::sleep(0);
+			}
+			tcp_socket::result res;
+			_currBytes += s;
+			_iov.advance(s);
+			if (ec || _iov.completed())
+			{
+				do
+				{
+					res = { _currBytes, ec.value(), !ec };
+#ifndef HAS_ASIO_CANCEL_IO
+					if (boost::asio::error::operation_aborted == res.code && _sck._socket.is_open())
+					{
+						if (_iov.completed())
+						{
+							res.ok = true;
+							res.code = 0;
+						}
+						else if (!_sck._cancelRead)
+						{
+							break;
+						}
+					}
+#endif
+					DEBUG_OPERATION(_sck._reading = false);
+					_handler(res);
+					return;
+				} while (0);
+			}
+			try
+			{
+				do
+				{
+#ifdef HAS_ASIO_CANCEL_IO
+					if (_sck._cancelRead)
+					{
+						res = { _currBytes, ec.value(), !ec };
+						break;
+					}
+#endif
+					_sck._holdRead = true;
+					BREAK_OF_SCOPE_EXEC(_sck._holdRead = false);
+					const SocketIov_<boost::asio::mutable_buffer> iov(_iov);
+					_sck._socket.async_read_some(iov, std::move(*this));
+					if (_sck._cancelRead)
+					{
+						_sck.cancel_read();
+					}
+					return;
+				} while (0);
+			}
+			catch (const boost::system::system_error& se)
+			{
+				res = { _currBytes, se.code().value(), !se.code() };
+			}
+			DEBUG_OPERATION(_sck._reading = false);
+			_handler(res);
+		}
+
+#ifdef HAS_ASIO_HANDLER_IS_TRIED
+		friend bool asio_handler_is_tried(async_readv_op*)
+		{
+			return true;
+		}
+#endif
+
+		handler_type _handler;
+		tcp_socket& _sck;
+		SocketIov_<boost::asio::mutable_buffer> _iov;
+		size_t _currBytes;
+		COPY_CONSTRUCT4(async_readv_op, _handler, _sck, _iov, _currBytes);
+	};
+
+	template <typename Handler>
+	struct async_writev_op
+	{
+		typedef RM_CREF(Handler) handler_type;
+
+		async_writev_op(Handler& handler, tcp_socket& sck, const SocketIov_<boost::asio::const_buffer>& iov)
+			:_handler(std::forward<Handler>(handler)), _sck(sck), _iov(iov), _currBytes(0) {}
+
+		void operator()(const boost::system::error_code& ec, size_t s)
+		{
+			while (_sck._holdWrite)
+			{
+				run_thread::sleep(0);
+			}
+			tcp_socket::result res;
+			_currBytes += s;
+			_iov.advance(s);
+			if (ec || _iov.completed())
+			{
+				do
+				{
+					res = { _currBytes, ec.value(), !ec };
+#ifndef HAS_ASIO_CANCEL_IO
+					if (boost::asio::error::operation_aborted == res.code && _sck._socket.is_open())
+					{
+						if (_iov.completed())
+						{
+							res.ok = true;
+							res.code = 0;
+						}
+						else if (!_sck._cancelWrite)
+						{
+							break;
+						}
+					}
+#endif
+					DEBUG_OPERATION(_sck._writing = false);
+					_handler(res);
+					return;
+				} while (0);
+			}
+			try
+			{
+				do
+				{
+#ifdef HAS_ASIO_CANCEL_IO
+					if (_sck._cancelWrite)
+					{
+						res = { _currBytes, ec.value(), !ec };
+						break;
+					}
+#endif
+					_sck._holdWrite = true;
+					BREAK_OF_SCOPE_EXEC(_sck._holdWrite = false);
+					const SocketIov_<boost::asio::const_buffer> iov(_iov);
+					_sck._socket.async_write_some(iov, std::move(*this));
+					if (_sck._cancelWrite)
+					{
+						_sck.cancel_write();
+					}
+					return;
+				} while (0);
+			}
+			catch (const boost::system::system_error& se)
+			{
+				res = { _currBytes, se.code().value(), !se.code() };
+			}
+			DEBUG_OPERATION(_sck._writing = false);
+			_handler(res);
+		}
+
+#ifdef HAS_ASIO_HANDLER_IS_TRIED
+		friend bool asio_handler_is_tried(async_writev_op*)
+		{
+			return true;
+		}
+#endif
+
+		handler_type _handler;
+		tcp_socket& _sck;
+		SocketIov_<boost::asio::const_buffer> _iov;
+		size_t _currBytes;
+		COPY_CONSTRUCT4(async_writev_op, _handler, _sck, _iov, _currBytes);
+	};
+
 #ifdef HAS_ASIO_SEND_FILE
 #ifdef __linux__
 	template <typename Handler>
@@ -348,6 +817,11 @@ public:
 	*/
 	result cancel_write();
 
+	/*!
+	@brief 登记到超时表(NULL取消登记)，之后在该表strand中的timed_xxx操作由超时表统一计时
+	*/
+	void set_deadline_list(socket_deadline_list* deadlines);
+
 	/*!
 	@brief 往缓冲区内读取数据，直到读满
 	*/
@@ -368,12 +842,31 @@ public:
 	*/
 	result write_some(my_actor* host, const void* buff, size_t length);
 
+	/*!
+	@brief 往多个缓冲区内依次读取数据，直到全部读满
+	*/
+	result readv(my_actor* host, const boost::asio::mutable_buffer* buffs, size_t count);
+
+	/*!
+	@brief 将多个缓冲区的数据依次全部发送出去，部分发送后自动续发剩余部分
+	*/
+	result writev(my_actor* host, const boost::asio::const_buffer* buffs, size_t count);
+	result write(my_actor* host, const buffer_chain& chain);
+
 	/*!
 	@brief 在ms时间范围内，客户端模式下连接远端服务器
 	*/
 	result timed_connect(my_actor* host, int ms, const boost::asio::ip::tcp::endpoint& remoteEndpoint);
 	result timed_connect(my_actor* host, int ms, const char* remoteIp, unsigned short remotePort);
 
+	/*!
+	@brief 在ms时间范围内(ms<0不限时)，同时发起多个socket到同一远端的非阻塞连接，全部完成后返回
+	@param results 每个socket的连接结果，可为NULL
+	@return s为连接成功的个数
+	*/
+	static result timed_connect_n(my_actor* host, int ms, const boost::asio::ip::tcp::endpoint& remoteEndpoint, tcp_socket* const* sockets, size_t count, result* results = NULL);
+	static result connect_n(my_actor* host, const boost::asio::ip::tcp::endpoint& remoteEndpoint, tcp_socket* const* sockets, size_t count, result* results = NULL);
+
 	/*!
 	@brief 在ms时间范围内，往缓冲区内读取数据，直到读满
 	*/
@@ -395,7 +888,39 @@ public:
 	result timed_write_some(my_actor* host, int ms, const void* buff, size_t length);
 
 	/*!
-	@brief 关闭socket
+	@brief 在ms时间范围内，往多个缓冲区内依次读取数据，直到全部读满
+	*/
+	result timed_readv(my_actor* host, int ms, const boost::asio::mutable_buffer* buffs, size_t count);
+
+	/*!
+	@brief 在ms时间范围内，将多个缓冲区的数据依次全部发送出去
+	*/
+	result timed_writev(my_actor* host, int ms, const boost::asio::const_buffer* buffs, size_t count);
+	result timed_write(my_actor* host, int ms, const buffer_chain& chain);
+
+	/*!
+	@brief 开启MSG_ZEROCOPY零拷贝发送(linux 4.14以上)，不小于threshold字节的 zero_copy_write 使用零拷贝，其它回退为普通发送
+	*/
+	result zero_copy(size_t threshold = 64 * 1024);
+
+	/*!
+	@brief 将数据全部发送出去，使用零拷贝时等到内核不再引用buff后才返回，
+	期间一并等待之前所有未完成的零拷贝发送(包括chain)，直到对端确认，没有超时
+	*/
+	result zero_copy_write(my_actor* host, const void* buff, size_t length);
+
+	/*!
+	@brief 将缓存链全部发送出去后立即返回，使用零拷贝时chain的引用保留到内核不再使用为止
+	*/
+	result zero_copy_write(my_actor* host, const buffer_chain& chain);
+
+	/*!
+	@brief 等待所有零拷贝发送的缓存被内核释放，以退避轮询方式等待，没有超时
+	*/
+	result zero_copy_flush(my_actor* host);
+
+	/*!
+	@brief 关闭socket，仍被内核引用的零拷贝缓存链保留到释放通知到达为止
 	*/
 	result close();
 
@@ -404,6 +929,11 @@ public:
 	*/
 	bool is_open();
 
+	/*!
+	@brief 用MSG_PEEK非阻塞窥探空闲连接是否仍可用(对端未关闭、没有错误、没有未读数据)
+	*/
+	bool probe_idle();
+
 	/*!
 	@brief 交换
 	*/
@@ -659,52 +1189,120 @@ public:
 			}
 		}
 #endif
-		try
+		try
+		{
+			if (buff && length)
+			{
+#ifdef HAS_ASIO_HANDLER_IS_TRIED
+#ifdef ENABLE_ASIO_PRE_OP
+				if (is_pre_option())
+				{
+					_socket.async_write_some(boost::asio::buffer((const char*)buff + trySize, length - trySize),
+						async_write_op<Handler>(handler, *this, buff, trySize, length));
+				}
+				else
+#endif
+				{
+					_socket.async_write_some(boost::asio::buffer((const char*)buff + trySize, length - trySize),
+						wrap_no_tried(async_write_op<Handler>(handler, *this, buff, trySize, length)));
+				}
+#else
+				_socket.async_write_some(boost::asio::buffer((const char*)buff + trySize, length - trySize),
+					async_write_op<Handler>(handler, *this, buff, trySize, length));
+#endif
+			}
+			else
+			{
+#if defined(ENABLE_ASIO_PRE_OP) && defined(HAS_ASIO_HANDLER_IS_TRIED)
+				if (is_pre_option())
+				{
+					_socket.async_write_some(boost::asio::null_buffers(), wrap_tried(std::bind([this, buff, length](Handler& handler, const boost::system::error_code& ec, size_t s)
+					{
+						async_write_some_handler(buff, length, std::move(handler), ec, s);
+					}, std::forward<Handler>(handler), __1, __2)));
+				}
+				else
+#endif
+				{
+					_socket.async_write_some(boost::asio::null_buffers(), std::bind([this, buff, length](Handler& handler, const boost::system::error_code& ec, size_t s)
+					{
+						async_write_some_handler(buff, length, std::move(handler), ec, s);
+					}, std::forward<Handler>(handler), __1, __2));
+				}
+			}
+			return false;
+		}
+		catch (const boost::system::system_error& se)
+		{
+			res = { 0, se.code().value(), !se.code() };
+		}
+#if (_DEBUG || DEBUG)
+		return check_immed_callback(std::forward<Handler>(handler), res, _writing);
+#else
+		return check_immed_callback(std::forward<Handler>(handler), res);
+#endif
+	}
+
+	/*!
+	@brief 异步模式下，往多个缓冲区内依次读取数据，直到全部读满，buffs在完成前须保持有效
+	*/
+	template <typename Handler>
+	bool async_readv(const boost::asio::mutable_buffer* buffs, size_t count, Handler&& handler)
+	{
+		assert(!_reading);
+		DEBUG_OPERATION(_reading = true);
+		result res = { 0, 0, true };
+		_cancelRead = false;
+		SocketIov_<boost::asio::mutable_buffer> iov(buffs, count);
+		if (!iov.completed())
+		{
+			try
+			{
+#ifdef HAS_ASIO_HANDLER_IS_TRIED
+				_socket.async_read_some(iov, wrap_no_tried(async_readv_op<Handler>(handler, *this, iov)));
+#else
+				_socket.async_read_some(iov, async_readv_op<Handler>(handler, *this, iov));
+#endif
+				return false;
+			}
+			catch (const boost::system::system_error& se)
+			{
+				res = { 0, se.code().value(), !se.code() };
+			}
+		}
+#if (_DEBUG || DEBUG)
+		return check_immed_callback(std::forward<Handler>(handler), res, _reading);
+#else
+		return check_immed_callback(std::forward<Handler>(handler), res);
+#endif
+	}
+
+	/*!
+	@brief 异步模式下，将多个缓冲区的数据依次全部发送出去(writev)，部分发送后自动续发剩余部分，buffs在完成前须保持有效
+	*/
+	template <typename Handler>
+	bool async_writev(const boost::asio::const_buffer* buffs, size_t count, Handler&& handler)
+	{
+		assert(!_writing);
+		DEBUG_OPERATION(_writing = true);
+		result res = { 0, 0, true };
+		_cancelWrite = false;
+		SocketIov_<boost::asio::const_buffer> iov(buffs, count);
+		if (!iov.completed())
 		{
-			if (buff && length)
+			try
 			{
 #ifdef HAS_ASIO_HANDLER_IS_TRIED
-#ifdef ENABLE_ASIO_PRE_OP
-				if (is_pre_option())
-				{
-					_socket.async_write_some(boost::asio::buffer((const char*)buff + trySize, length - trySize),
-						async_write_op<Handler>(handler, *this, buff, trySize, length));
-				}
-				else
-#endif
-				{
-					_socket.async_write_some(boost::asio::buffer((const char*)buff + trySize, length - trySize),
-						wrap_no_tried(async_write_op<Handler>(handler, *this, buff, trySize, length)));
-				}
+				_socket.async_write_some(iov, wrap_no_tried(async_writev_op<Handler>(handler, *this, iov)));
 #else
-				_socket.async_write_some(boost::asio::buffer((const char*)buff + trySize, length - trySize),
-					async_write_op<Handler>(handler, *this, buff, trySize, length));
+				_socket.async_write_some(iov, async_writev_op<Handler>(handler, *this, iov));
 #endif
+				return false;
 			}
-			else
+			catch (const boost::system::system_error& se)
 			{
-#if defined(ENABLE_ASIO_PRE_OP) && defined(HAS_ASIO_HANDLER_IS_TRIED)
-				if (is_pre_option())
-				{
-					_socket.async_write_some(boost::asio::null_buffers(), wrap_tried(std::bind([this, buff, length](Handler& handler, const boost::system::error_code& ec, size_t s)
-					{
-						async_write_some_handler(buff, length, std::move(handler), ec, s);
-					}, std::forward<Handler>(handler), __1, __2)));
-				}
-				else
-#endif
-				{
-					_socket.async_write_some(boost::asio::null_buffers(), std::bind([this, buff, length](Handler& handler, const boost::system::error_code& ec, size_t s)
-					{
-						async_write_some_handler(buff, length, std::move(handler), ec, s);
-					}, std::forward<Handler>(handler), __1, __2));
-				}
+				res = { 0, se.code().value(), !se.code() };
 			}
-			return false;
-		}
-		catch (const boost::system::system_error& se)
-		{
-			res = { 0, se.code().value(), !se.code() };
 		}
 #if (_DEBUG || DEBUG)
 		return check_immed_callback(std::forward<Handler>(handler), res, _writing);
@@ -713,6 +1311,15 @@ public:
 #endif
 	}
 
+	/*!
+	@brief 异步模式下，将缓存链全部发送出去，chain在完成前须保持有效
+	*/
+	template <typename Handler>
+	bool async_write(const buffer_chain& chain, Handler&& handler)
+	{
+		return async_writev(chain.buffers(), chain.count(), std::forward<Handler>(handler));
+	}
+
 	/*!
 	@brief 异步模式下，将数据发送出去，能发多少是多少
 	*/
@@ -1098,9 +1705,32 @@ private:
 #endif
 	result _try_mwrite_same(const void* const* buffs, const size_t* lengths, size_t count);
 	result _try_mread_same(void* const* buffs, const size_t* lengths, size_t count);
+	result zero_copy_send(my_actor* host, const boost::asio::const_buffer* buffs, size_t count);
+	result wait_ready(my_actor* host, int ms, bool write);
+	void zero_copy_reap();
 	void set_internal_non_blocking();
+	static void deadline_cancel(void* owner, int slot);
 private:
+	/*!
+	@brief 零拷贝发送状态，每次成功的MSG_ZEROCOPY发送占用一个序号，内核按序号区间通知释放
+	*/
+	struct zero_copy_state
+	{
+		size_t _threshold;
+		unsigned _sendSeq;
+		unsigned _doneSeq;
+		msg_queue<std::pair<unsigned, buffer_chain> > _holders;
+	};
+
+	static bool zero_copy_reap(int fd, zero_copy_state& zc);
+	static void zero_copy_orphan(int fd, std::unique_ptr<zero_copy_state>&& zc);
+	static void zero_copy_reap_orphans();
+	static std::mutex _zeroCopyOrphanMutex;
+	static std::list<std::pair<int, std::unique_ptr<zero_copy_state> > > _zeroCopyOrphans;//关闭时仍有未完成零拷贝发送的dup句柄
+
 	boost::asio::ip::tcp::socket _socket;
+	std::unique_ptr<zero_copy_state> _zeroCopy;
+	socket_deadline_list::node* _deadline;
 #ifdef HAS_ASIO_SEND_FILE
 #ifdef __linux__
 	boost::asio::detail::socket_ops::send_file_pck _sendFileState;
@@ -1146,6 +1776,11 @@ public:
 	*/
 	tcp_socket::result open_v6(unsigned short port);
 
+	/*!
+	@brief 以SO_REUSEPORT方式打开服务器，多个侦听器可绑定同一端口，由内核分配新连接(不支持时不复用地址，Windows下以SO_EXCLUSIVEADDRUSE独占)
+	*/
+	tcp_socket::result open_reuse_port(const boost::asio::ip::tcp::endpoint& endPoint);
+
 	/*!
 	@brief 用原始句柄构造
 	*/
@@ -1192,6 +1827,11 @@ public:
 	*/
 	tcp_socket::result accept(my_actor* host, tcp_socket& socket);
 
+	/*!
+	@brief 登记到超时表(NULL取消登记)，之后在该表strand中的timed_accept由超时表统一计时
+	*/
+	void set_deadline_list(socket_deadline_list* deadlines);
+
 	/*!
 	@brief 在ms时间范围内，用socket侦听客户端连接
 	*/
@@ -1262,12 +1902,18 @@ public:
 		}, std::forward<Handler>(handler), res));
 		return false;
 	}
+
+	/*!
+	@brief 非阻塞尝试接受一个连接，没有待接受的连接时返回would_block
+	*/
+	tcp_socket::result try_accept(tcp_socket& socket);
 private:
 	void set_internal_non_blocking();
-	tcp_socket::result try_accept(tcp_socket& socket);
+	static void deadline_cancel(void* owner, int slot);
 private:
 	io_engine* _ios;
 	stack_obj<boost::asio::ip::tcp::acceptor> _acceptor;
+	socket_deadline_list::node* _deadline;
 	bool _nonBlocking;
 #ifdef ENABLE_ASIO_PRE_OP
 	bool _preOption;
@@ -1275,6 +1921,349 @@ private:
 	NONE_COPY(tcp_acceptor);
 };
 
+/*!
+@brief 分片服务器侦听器，每个分片一个SO_REUSEPORT侦听器和一个Actor，由内核在分片间分配新连接；
+分片有连接就绪后批量接收直到没有已完成握手的连接，新连接在接收它的分片strand中交给处理函数
+*/
+class tcp_shard_acceptor
+{
+	struct shard
+	{
+		shard(io_engine& ios)
+		:_strand(boost_strand::create(ios)), _acceptor(ios) {}
+
+		shared_strand _strand;
+		tcp_acceptor _acceptor;
+		actor_handle _actor;
+	};
+public:
+	/*!
+	@brief 新连接处理函数，在接收分片的strand中调用
+	*/
+	typedef std::function<void(const shared_strand&, std::shared_ptr<tcp_socket>&&)> accept_handler;
+
+	tcp_shard_acceptor(io_engine& ios);
+	~tcp_shard_acceptor();
+public:
+	/*!
+	@brief 打开服务器
+	@param shards 分片数，0为io_engine线程数；不支持SO_REUSEPORT时只有1个分片
+	@param batch 每次就绪后最多连续接收的连接数
+	*/
+	tcp_socket::result open(const boost::asio::ip::tcp::endpoint& endPoint, accept_handler h, size_t shards = 0, size_t batch = 64);
+	tcp_socket::result open(const char* ip, unsigned short port, accept_handler h, size_t shards = 0, size_t batch = 64);
+	tcp_socket::result open_v4(unsigned short port, accept_handler h, size_t shards = 0, size_t batch = 64);
+
+	/*!
+	@brief 关闭所有分片，等待分片Actor退出
+	*/
+	__yield_interrupt void close(my_actor* host);
+
+	/*!
+	@brief 分片数
+	*/
+	size_t shards();
+
+	/*!
+	@brief 是否没close
+	*/
+	bool is_open();
+private:
+	static void shard_run(my_actor* host, shard& sd, const accept_handler& h, size_t batch);
+private:
+	io_engine* _ios;
+	std::vector<std::unique_ptr<shard> > _shards;
+	NONE_COPY(tcp_shard_acceptor);
+};
+
+/*!
+@brief tcp_socket上的缓冲读取器，每次尽量读取一大块到内部缓存，再从中切分出帧，减少小消息的读调用次数；
+返回的数据直接指向内部缓存，在下一次读取操作前有效
+*/
+class tcp_frame_reader
+{
+public:
+	typedef socket_result result;
+public:
+	/*!
+	@param bufferSize 内部缓存初始大小
+	@param headBytes 帧长度头字节数(1/2/4/8)，长度不包含头部
+	@param bigEndian 帧长度头是否为大端
+	@param maxFrame 最大帧长度，超过时缓存不再扩展，返回message_size错误，默认16MB，0为不限制(帧长度来自对端，慎用)
+	*/
+	tcp_frame_reader(tcp_socket& socket, size_t bufferSize = 64 * 1024, size_t headBytes = 4, bool bigEndian = true, size_t maxFrame = 16 * 1024 * 1024);
+public:
+	/*!
+	@brief 读取一个长度前缀的帧，frame指向帧数据(不含头部)
+	*/
+	result read_frame(my_actor* host, const char*& frame, size_t& length);
+
+	/*!
+	@brief 在ms时间范围内，读取一个长度前缀的帧
+	*/
+	result timed_read_frame(my_actor* host, int ms, const char*& frame, size_t& length);
+
+	/*!
+	@brief 读取直到遇到分隔符，data指向读取的数据(包含分隔符)
+	*/
+	result read_until(my_actor* host, const char* delim, size_t delimLength, const char*& data, size_t& length);
+
+	/*!
+	@brief 在ms时间范围内，读取直到遇到分隔符
+	*/
+	result timed_read_until(my_actor* host, int ms, const char* delim, size_t delimLength, const char*& data, size_t& length);
+
+	/*!
+	@brief 预读length字节数据但不取出，data指向预读的数据
+	*/
+	result peek(my_actor* host, size_t length, const char*& data);
+
+	/*!
+	@brief 在ms时间范围内，预读length字节数据但不取出
+	*/
+	result timed_peek(my_actor* host, int ms, size_t length, const char*& data);
+
+	/*!
+	@brief 取出length字节已缓存的数据
+	*/
+	void consume(size_t length);
+
+	/*!
+	@brief 已缓存未取出的字节数
+	*/
+	size_t available();
+
+	/*!
+	@brief 累计读调用次数
+	*/
+	size_t read_count();
+private:
+	result fill(my_actor* host, long long deadline, size_t length);
+	void drop_pending();
+	unsigned long long frame_length(const char* head);
+private:
+	tcp_socket* _socket;
+	std::vector<char> _buffer;
+	size_t _begin;
+	size_t _end;
+	size_t _pending;
+	size_t _scanned;
+	size_t _readCount;
+	const size_t _maxFrame;
+	const unsigned char _headBytes;
+	const bool _bigEndian;
+	NONE_COPY(tcp_frame_reader);
+};
+
+/*!
+@brief tcp_socket上的写合并器，同一次strand调度内(或达到字节/时间阈值前)的多次小写入先追加到发送队列，
+之后合并为一次写调用发出；写入只在发送队列超过上限时挂起，发送失败在之后的write/flush中返回；
+只能在strand所属的Actor中使用，析构前须flush
+*/
+class tcp_cork_writer
+{
+public:
+	typedef socket_result result;
+public:
+	/*!
+	@param flushBytes 队列达到该字节数时立即发送
+	@param delayUs 首次写入后最多延迟多少微秒发送，0为在本次strand调度结束后发送
+	@param maxBytes 队列上限，超过时写入挂起直到正在进行的发送完成
+	*/
+	tcp_cork_writer(const shared_strand& strand, tcp_socket& socket, size_t flushBytes = 64 * 1024, int delayUs = 0, size_t maxBytes = 4 * 1024 * 1024);
+	~tcp_cork_writer();
+public:
+	/*!
+	@brief 追加数据到发送队列
+	@param flushNow 立即发送队列中的数据(不等待发送完成)，用于延迟敏感的消息
+	*/
+	result write(my_actor* host, const void* buff, size_t length, bool flushNow = false);
+
+	/*!
+	@brief 立即发送队列中的数据，并等待全部发送完成
+	*/
+	result flush(my_actor* host);
+
+	/*!
+	@brief 队列中等待发送的字节数
+	*/
+	size_t pending();
+
+	/*!
+	@brief 累计发出的写调用次数
+	*/
+	size_t write_count();
+private:
+	void schedule();
+	void kick();
+	void on_sent(const result& res);
+	void wait(my_actor* host);
+private:
+	shared_strand _strand;
+	tcp_socket* _socket;
+	std::shared_ptr<tcp_cork_writer*> _self;
+	async_timer _timer;
+	std::vector<char> _queue[2];
+	std::vector<trig_once_notifer<> > _waiters;
+	result _error;
+	size_t _writeCount;
+	const size_t _flushBytes;
+	const size_t _maxBytes;
+	const int _delayUs;
+	unsigned char _back;
+	bool _sending;
+	bool _scheduled;
+	NONE_COPY(tcp_cork_writer);
+};
+
+/*!
+@brief 出站tcp连接池，按远端地址缓存空闲连接，可在同一io_engine上不同strand的Actor间共用；
+取出时用MSG_PEEK窥探并丢弃已失效的连接，没有可用连接时新建；每个地址最多保留maxIdle个空闲连接，空闲超过maxIdleMs的连接被关闭
+*/
+class tcp_connection_pool
+{
+	struct idle_socket
+	{
+		std::shared_ptr<tcp_socket> _socket;
+		long long _tick;
+	};
+public:
+	/*!
+	@param connectMs 新建连接超时
+	*/
+	tcp_connection_pool(io_engine& ios, size_t maxIdle = 16, int maxIdleMs = 60000, int connectMs = 3000);
+	~tcp_connection_pool();
+public:
+	/*!
+	@brief 并行建立count个到远端的连接放入池中(不超过maxIdle)
+	@return s为成功建立的连接数
+	*/
+	tcp_socket::result warm_up(my_actor* host, const boost::asio::ip::tcp::endpoint& remoteEndpoint, size_t count);
+
+	/*!
+	@brief 取出一个到远端的可用连接，没有时新建
+	*/
+	tcp_socket::result checkout(my_actor* host, const boost::asio::ip::tcp::endpoint& remoteEndpoint, std::shared_ptr<tcp_socket>& socket);
+
+	/*!
+	@brief 归还连接，reusable为false(如协议出错、有未读完的数据)时直接关闭
+	*/
+	void checkin(const boost::asio::ip::tcp::endpoint& remoteEndpoint, std::shared_ptr<tcp_socket>&& socket, bool reusable = true);
+
+	/*!
+	@brief 关闭空闲超时的连接
+	@return 关闭的连接数
+	*/
+	size_t shrink();
+
+	/*!
+	@brief 关闭所有空闲连接
+	*/
+	void clear();
+
+	/*!
+	@brief 空闲连接数
+	*/
+	size_t idle_count();
+
+	/*!
+	@brief 累计新建的连接数
+	*/
+	size_t connect_count();
+private:
+	void close_expired(std::vector<idle_socket>& idles, long long now, std::vector<std::shared_ptr<tcp_socket> >& closes);
+private:
+	io_engine* _ios;
+	std::mutex _mutex;
+	std::map<boost::asio::ip::tcp::endpoint, std::vector<idle_socket> > _idles;
+	size_t _idleCount;
+	size_t _connectCount;
+	const size_t _maxIdle;
+	const int _maxIdleMs;
+	const int _connectMs;
+	NONE_COPY(tcp_connection_pool);
+};
+
+#ifdef __linux__
+/*!
+@brief 基于splice的转发管道，经由一对管道在socket与socket/文件之间搬运数据，数据不经过用户空间；
+每个转发Actor持有一个，可重复使用
+*/
+class tcp_splice_pipe
+{
+public:
+	typedef socket_result result;
+public:
+	/*!
+	@param pipeSize 管道容量，0为系统默认
+	*/
+	tcp_splice_pipe(size_t pipeSize = 0);
+	~tcp_splice_pipe();
+public:
+	/*!
+	@brief 管道是否创建成功
+	*/
+	bool is_open();
+
+	/*!
+	@brief 从src转发length字节数据到dst，length为0时一直转发到src对端关闭
+	*/
+	result relay(my_actor* host, tcp_socket& src, tcp_socket& dst, size_t length = 0);
+
+	/*!
+	@brief 在ms时间范围内，从src转发数据到dst
+	*/
+	result timed_relay(my_actor* host, int ms, tcp_socket& src, tcp_socket& dst, size_t length = 0);
+
+	/*!
+	@brief 从文件fd的offset处(为NULL时从当前位置)发送length字节到dst，length为0时发送到文件尾
+	*/
+	result send_file(my_actor* host, int fd, unsigned long long* offset, size_t length, tcp_socket& dst);
+
+	/*!
+	@brief 在ms时间范围内，从文件发送数据到dst
+	*/
+	result timed_send_file(my_actor* host, int ms, int fd, unsigned long long* offset, size_t length, tcp_socket& dst);
+
+	/*!
+	@brief 从src接收length字节写入文件fd的offset处(为NULL时写入当前位置)，length为0时一直接收到src对端关闭
+	*/
+	result recv_file(my_actor* host, tcp_socket& src, int fd, unsigned long long* offset, size_t length = 0);
+
+	/*!
+	@brief 在ms时间范围内，从src接收数据写入文件
+	*/
+	result timed_recv_file(my_actor* host, int ms, tcp_socket& src, int fd, unsigned long long* offset, size_t length = 0);
+
+	/*!
+	@brief 累计从源读入管道的字节数
+	*/
+	unsigned long long in_bytes();
+
+	/*!
+	@brief 累计从管道写出到目标的字节数
+	*/
+	unsigned long long out_bytes();
+
+	/*!
+	@brief 清零字节计数
+	*/
+	void reset_bytes();
+private:
+	result transfer(my_actor* host, long long deadline, tcp_socket* srcSck, int srcFd, unsigned long long* srcOff,
+		tcp_socket* dstSck, int dstFd, unsigned long long* dstOff, size_t length);
+	bool open_pipe();
+	void close_pipe();
+private:
+	int _pipe[2];
+	size_t _pipeSize;
+	size_t _buffered;
+	unsigned long long _inBytes;
+	unsigned long long _outBytes;
+	NONE_COPY(tcp_splice_pipe);
+};
+#endif
+
 /*!
 @brief udp通信
 */
@@ -1783,6 +2772,18 @@ public:
 	*/
 	result try_mreceive_from(boost::asio::ip::udp::endpoint* remoteEndpoints, void* const* buffs, const size_t* lengths, size_t count, size_t* bytes = NULL, int flags = 0);
 
+	/*!
+	@brief 开启UDP_SEGMENT(GSO)发送(linux 4.18以上)，之后 try_msend/try_msend_to 将发往同一目标、长度相同(最后一条可以更短)的
+	连续数据合并为一个超级报文交给内核分段，设备不支持时自动关闭
+	*/
+	result gso(bool enable = true);
+
+	/*!
+	@brief 开启UDP_GRO接收(linux 5.0以上)，内核将同一来源的连续报文合并后一次交付，try_mreceive/try_mreceive_from 再将其拆分到各缓存；
+	开启后应只使用 try_mreceive/try_mreceive_from 接收
+	*/
+	result gro(bool enable = true);
+
 	/*!
 	@brief try_io操作失败是否是因为EAGAIN
 	*/
@@ -2013,10 +3014,25 @@ private:
 		return false;
 	}
 private:
+	result _try_gso_msend(const boost::asio::ip::udp::endpoint* remoteEndpoints, size_t endpointStep, const void* const* buffs, const size_t* lengths, size_t count, size_t* bytes, int flags);
+	result _try_gro_mreceive(boost::asio::ip::udp::endpoint* remoteEndpoints, void* const* buffs, const size_t* lengths, size_t count, size_t* bytes, int flags);
 	void set_internal_non_blocking();
 private:
+	/*!
+	@brief GRO接收的超级报文暂存，按段大小拆分后依次取出
+	*/
+	struct gro_state
+	{
+		std::vector<char> _buff;
+		boost::asio::ip::udp::endpoint _remoteEndpoint;
+		size_t _pos;
+		size_t _segment;
+		size_t _remain;
+	};
+
 	boost::asio::ip::udp::socket _socket;
 	boost::asio::ip::udp::endpoint _remoteSenderEndpoint;
+	std::unique_ptr<gro_state> _gro;
 #ifndef HAS_ASIO_CANCEL_IO
 	volatile bool _holdRecv;
 	volatile bool _holdSend;
@@ -2024,6 +3040,7 @@ private:
 	volatile bool _cancelSend;
 #endif
 	bool _nonBlocking;
+	bool _gso;
 #ifdef ENABLE_ASIO_PRE_OP
 	bool _preOption;
 #endif
@@ -100,6 +100,8 @@
 #define CHECK_PUMP_LOST_ALLOC_INDEX 7
 #define ASIO_HANDLER_ALLOC_EX_INDEX 8
 #define IO_ENGINE_INDEX 9
+#define GENERATOR_CONTEXT_ALLOC_INDEX 10
+#define ID_BLOCK_INDEX 11
 
 static_assert(0 < MEM_PAGE_SIZE && MEM_PAGE_SIZE % (4 kB) == 0, "");
 static_assert(0 < MEM_POOL_LENGTH && MEM_POOL_LENGTH < 10000000, "");
@@ -0,0 +1,290 @@
+#ifndef __FORK_JOIN_H
+#define __FORK_JOIN_H
+
+#include <mutex>
+#include <atomic>
+#include <vector>
+#include <memory>
+#include <functional>
+#include "io_engine.h"
+#include "my_actor.h"
+#include "generator.h"
+
+//在generator中并行执行 __handler__(size_t i)，i属于[__begin__, __end__)，全部完成后返回
+#define co_parallel_for(__ios__, __begin__, __end__, __handler__) do{\
+	co_lock_stop; parallel_for(__ios__, __begin__, __end__, __handler__, co_async); _co_await; co_unlock_stop;\
+	}while (0)
+//在generator中并行归约，结果写入__res__
+#define co_parallel_reduce(__res__, __ios__, __begin__, __end__, __identity__, __map__, __reduce__) do{\
+	co_lock_stop; parallel_reduce(__ios__, __begin__, __end__, __identity__, __map__, __reduce__, co_async_result(__res__)); _co_await; co_unlock_stop;\
+	}while (0)
+//在generator中并行执行多个函数，全部完成后返回
+#define co_parallel_invoke(__ios__, ...) do{\
+	co_lock_stop; parallel_invoke(__ios__, co_async, __VA_ARGS__); _co_await; co_unlock_stop;\
+	}while (0)
+
+/*!
+@brief 单个工作者持有的待处理区间，自身从前端取块，其它工作者从后端窃取一半
+*/
+struct ForkJoinRange_
+{
+	ForkJoinRange_()
+	:_begin(0), _end(0) {}
+
+	std::mutex _mutex;
+	size_t _begin;
+	size_t _end;
+	char _pad[64];
+};
+
+template <typename Body>
+class ForkJoinJob_
+{
+	typedef std::shared_ptr<ForkJoinJob_> job_handle;
+public:
+	ForkJoinJob_(size_t begin, size_t end, size_t workers, size_t grain, Body&& body, std::function<void()>&& ntf)
+		:_body(std::move(body)), _ntf(std::move(ntf)), _ranges(new ForkJoinRange_[workers]), _workers(workers), _grain(grain), _remain(end - begin)
+	{
+		const size_t length = end - begin;
+		for (size_t i = 0; i < workers; i++)
+		{
+			_ranges[i]._begin = begin + length * i / workers;
+			_ranges[i]._end = begin + length * (i + 1) / workers;
+		}
+	}
+
+	static void start(io_engine& ios, const job_handle& job)
+	{
+		for (size_t i = 0; i < job->_workers; i++)
+		{
+			((boost::asio::io_service&)ios).post(std::bind([](const job_handle& job, size_t self)
+			{
+				job->run(self);
+			}, job, i));
+		}
+	}
+private:
+	void run(size_t self)
+	{
+		size_t begin, end;
+		while (true)
+		{
+			if (claim(self, begin, end))
+			{
+				_body(self, begin, end);
+				if (0 == (_remain -= end - begin))
+				{
+					_ntf();
+				}
+			}
+			else if (!steal(self))
+			{
+				break;
+			}
+		}
+	}
+
+	/*!
+	@brief 从自己的区间前端取一块，块大小随剩余量缩小
+	*/
+	bool claim(size_t self, size_t& begin, size_t& end)
+	{
+		ForkJoinRange_& range = _ranges[self];
+		std::lock_guard<std::mutex> lg(range._mutex);
+		const size_t length = range._end - range._begin;
+		if (!length)
+		{
+			return false;
+		}
+		size_t chunk = length / 4;
+		chunk = chunk < _grain ? _grain : chunk;
+		chunk = chunk > length ? length : chunk;
+		begin = range._begin;
+		end = begin + chunk;
+		range._begin = end;
+		return true;
+	}
+
+	/*!
+	@brief 自己的区间取完后，从其它工作者区间后端窃取一半
+	*/
+	bool steal(size_t self)
+	{
+		for (size_t i = 1; i < _workers; i++)
+		{
+			size_t begin, end;
+			{
+				ForkJoinRange_& victim = _ranges[(self + i) % _workers];
+				std::lock_guard<std::mutex> lg(victim._mutex);
+				const size_t length = victim._end - victim._begin;
+				if (!length)
+				{
+					continue;
+				}
+				end = victim._end;
+				begin = end - (length + 1) / 2;
+				victim._end = begin;
+			}
+			ForkJoinRange_& range = _ranges[self];
+			std::lock_guard<std::mutex> lg(range._mutex);
+			assert(range._begin == range._end);
+			range._begin = begin;
+			range._end = end;
+			return true;
+		}
+		return false;
+	}
+private:
+	Body _body;
+	std::function<void()> _ntf;
+	std::unique_ptr<ForkJoinRange_[]> _ranges;
+	const size_t _workers;
+	const size_t _grain;
+	std::atomic<size_t> _remain;
+	NONE_COPY(ForkJoinJob_);
+};
+
+/*!
+@brief 并行工作者个数，不超过调度器线程数与块数
+*/
+inline size_t _fork_join_workers(io_engine& ios, size_t length, size_t grain)
+{
+	const size_t chunks = (length + grain - 1) / grain;
+	const size_t threads = ios.ioThreads();
+	return threads < chunks ? threads : chunks;
+}
+
+/*!
+@brief 在ios的线程上并行执行 h(size_t i)，i属于[begin, end)，按块分配，空闲线程窃取其它线程的剩余块
+@param grain 最小块大小
+@param ntf 全部完成后在最后完成的线程中回调
+*/
+template <typename Handler>
+void parallel_for(io_engine& ios, size_t begin, size_t end, Handler&& h, std::function<void()> ntf, size_t grain = 1)
+{
+	assert(grain);
+	if (begin >= end)
+	{
+		ntf();
+		return;
+	}
+	typedef RM_CREF(Handler) handler_type;
+	auto body = std::bind([](handler_type& h, size_t, size_t begin, size_t end)
+	{
+		for (size_t i = begin; i < end; i++)
+		{
+			h(i);
+		}
+	}, std::forward<Handler>(h), __1, __2, __3);
+	typedef ForkJoinJob_<decltype(body)> job_type;
+	job_type::start(ios, std::shared_ptr<job_type>(new job_type(begin, end,
+		_fork_join_workers(ios, end - begin, grain), grain, std::move(body), std::move(ntf))));
+}
+
+/*!
+@brief 在ios的线程上并行归约 reduce(...reduce(identity, map(i))...)，reduce须满足结合律与交换律
+@param ntf 全部完成后回调归约结果
+*/
+template <typename T, typename Map, typename Reduce, typename Notify>
+void parallel_reduce(io_engine& ios, size_t begin, size_t end, const T& identity, Map&& map, Reduce&& reduce, Notify&& ntf, size_t grain = 1)
+{
+	assert(grain);
+	if (begin >= end)
+	{
+		ntf(identity);
+		return;
+	}
+	typedef RM_CREF(Map) map_type;
+	typedef RM_CREF(Reduce) reduce_type;
+	const size_t workers = _fork_join_workers(ios, end - begin, grain);
+	std::shared_ptr<std::vector<T>> partials(new std::vector<T>(workers, identity));
+	std::shared_ptr<reduce_type> sharedReduce(new reduce_type(std::forward<Reduce>(reduce)));
+	auto body = std::bind([](map_type& map, std::shared_ptr<std::vector<T>>& partials, std::shared_ptr<reduce_type>& reduce, size_t self, size_t begin, size_t end)
+	{
+		T& partial = (*partials)[self];
+		for (size_t i = begin; i < end; i++)
+		{
+			partial = (*reduce)(std::move(partial), map(i));
+		}
+	}, std::forward<Map>(map), partials, sharedReduce, __1, __2, __3);
+	typedef ForkJoinJob_<decltype(body)> job_type;
+	job_type::start(ios, std::shared_ptr<job_type>(new job_type(begin, end, workers, grain, std::move(body),
+		std::bind([](std::shared_ptr<std::vector<T>>& partials, std::shared_ptr<reduce_type>& reduce, std::function<void(T)>& ntf)
+	{
+		T result = std::move(partials->front());
+		for (size_t i = 1; i < partials->size(); i++)
+		{
+			result = (*reduce)(std::move(result), std::move((*partials)[i]));
+		}
+		ntf(std::move(result));
+	}, partials, sharedReduce, std::function<void(T)>(std::forward<Notify>(ntf))))));
+}
+
+/*!
+@brief 在ios的线程上并行执行多个函数
+@param ntf 全部完成后回调
+*/
+template <typename... Handlers>
+void parallel_invoke(io_engine& ios, std::function<void()> ntf, Handlers&&... hs)
+{
+	std::shared_ptr<std::vector<std::function<void()>>> handlers(new std::vector<std::function<void()>>{ std::function<void()>(std::forward<Handlers>(hs))... });
+	parallel_for(ios, 0, handlers->size(), [handlers](size_t i)
+	{
+		(*handlers)[i]();
+	}, std::move(ntf));
+}
+
+/*!
+@brief 在Actor中并行执行 h(size_t i)，挂起当前Actor直到全部完成，等待期间不响应强制退出
+*/
+template <typename Handler>
+__yield_interrupt void parallel_for(my_actor* host, io_engine& ios, size_t begin, size_t end, Handler&& h, size_t grain = 1)
+{
+	host->lock_quit();
+	host->trig([&](trig_once_notifer<>&& ntf)
+	{
+		parallel_for(ios, begin, end, [&h](size_t i)
+		{
+			h(i);
+		}, std::move(ntf), grain);
+	});
+	host->unlock_quit();
+}
+
+/*!
+@brief 在Actor中并行归约，挂起当前Actor直到完成
+*/
+template <typename T, typename Map, typename Reduce>
+__yield_interrupt T parallel_reduce(my_actor* host, io_engine& ios, size_t begin, size_t end, const T& identity, Map&& map, Reduce&& reduce, size_t grain = 1)
+{
+	host->lock_quit();
+	T result(identity);
+	host->trig<T>(result, [&](trig_once_notifer<T>&& ntf)
+	{
+		parallel_reduce(ios, begin, end, identity, [&map](size_t i)
+		{
+			return map(i);
+		}, [&reduce](T&& a, T&& b)
+		{
+			return reduce(std::move(a), std::move(b));
+		}, std::move(ntf), grain);
+	});
+	host->unlock_quit();
+	return result;
+}
+
+/*!
+@brief 在Actor中并行执行多个函数，挂起当前Actor直到全部完成
+*/
+template <typename... Handlers>
+__yield_interrupt void parallel_invoke(my_actor* host, io_engine& ios, Handlers&&... hs)
+{
+	host->lock_quit();
+	host->trig([&](trig_once_notifer<>&& ntf)
+	{
+		parallel_invoke(ios, std::move(ntf), std::forward<Handlers>(hs)...);
+	});
+	host->unlock_quit();
+}
+
+#endif
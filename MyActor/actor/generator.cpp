@@ -4,6 +4,86 @@ mem_alloc_base* generator::_genObjAlloc = NULL;
 std::atomic<long long>* generator::_id = NULL;
 any_accept generator::__anyAccept;
 
+//generator上下文按co_context_space_size分级，每级CO_CONTEXT_CLASS_SIZE字节
+#define CO_CONTEXT_CLASS_SIZE 16
+#define CO_CONTEXT_CLASS_COUNT 64
+//每级缓存的字节上限，跨线程释放的空间只缓存到该上限，多余的直接归还
+#define CO_CONTEXT_CACHE_BYTES (256 * 1024)
+
+/*!
+@brief 线程内的上下文空间分级缓存，上下文可能在其它线程释放，所以每个空间单独分配，只缓存不归属
+*/
+struct CoContextAlloc_
+{
+	struct node
+	{
+		node* _next;
+	};
+
+	CoContextAlloc_(size_t cacheBytes)
+	:_cacheBytes(cacheBytes)
+	{
+		memset(_freeList, 0, sizeof(_freeList));
+		memset(_freeNumber, 0, sizeof(_freeNumber));
+	}
+
+	~CoContextAlloc_()
+	{
+		for (size_t i = 0; i < CO_CONTEXT_CLASS_COUNT; i++)
+		{
+			while (_freeList[i])
+			{
+				node* t = _freeList[i];
+				_freeList[i] = t->_next;
+				free(t);
+			}
+		}
+	}
+
+	void* allocate(size_t idx)
+	{
+		node* p = _freeList[idx];
+		if (p)
+		{
+			_freeList[idx] = p->_next;
+			_freeNumber[idx]--;
+			return p;
+		}
+		return malloc((idx + 1) * CO_CONTEXT_CLASS_SIZE);
+	}
+
+	void deallocate(void* p, size_t idx)
+	{
+		if ((_freeNumber[idx] + 1) * (idx + 1) * CO_CONTEXT_CLASS_SIZE <= _cacheBytes)
+		{
+			_freeNumber[idx]++;
+			((node*)p)->_next = _freeList[idx];
+			_freeList[idx] = (node*)p;
+			return;
+		}
+		free(p);
+	}
+
+	node* _freeList[CO_CONTEXT_CLASS_COUNT];
+	size_t _freeNumber[CO_CONTEXT_CLASS_COUNT];
+	size_t _cacheBytes;
+};
+
+//每个线程一次从全局计数中预留的ID个数
+#define ID_BLOCK_SIZE 1024
+
+/*!
+@brief 线程私有的ID段，用完后再从全局计数中预留下一段
+*/
+struct IdBlock_
+{
+	IdBlock_()
+	:_next(0), _end(0) {}
+
+	long long _next;
+	long long _end;
+};
+
 void generator::install(std::atomic<long long>* id)
 {
 	_genObjAlloc = make_shared_space_alloc<generator, mem_alloc_tls<GENERATOR_ALLOC_INDEX, void>>(MEM_POOL_LENGTH, [](generator*){});
@@ -20,13 +100,47 @@ void generator::uninstall()
 void generator::tls_init()
 {
 	_genObjAlloc->tls_init();
+	io_engine::getTlsValueRef(GENERATOR_CONTEXT_ALLOC_INDEX) = new CoContextAlloc_(CO_CONTEXT_CACHE_BYTES);
+	io_engine::getTlsValueRef(ID_BLOCK_INDEX) = new IdBlock_;
 }
 
 void generator::tls_uninit()
 {
+	delete (IdBlock_*)io_engine::swapTlsValue(ID_BLOCK_INDEX, NULL);
+	delete (CoContextAlloc_*)io_engine::swapTlsValue(GENERATOR_CONTEXT_ALLOC_INDEX, NULL);
 	_genObjAlloc->tls_uninit();
 }
 
+void* generator::_co_ctx_alloc(size_t size)
+{
+	const size_t idx = (MEM_ALIGN(size, CO_CONTEXT_CLASS_SIZE) / CO_CONTEXT_CLASS_SIZE) - 1;
+	if (idx < CO_CONTEXT_CLASS_COUNT)
+	{
+		void** tlsSpace = io_engine::getTlsValueBuff();
+		if (tlsSpace && tlsSpace[GENERATOR_CONTEXT_ALLOC_INDEX])
+		{
+			return ((CoContextAlloc_*)tlsSpace[GENERATOR_CONTEXT_ALLOC_INDEX])->allocate(idx);
+		}
+		return malloc((idx + 1) * CO_CONTEXT_CLASS_SIZE);
+	}
+	return malloc(size);
+}
+
+void generator::_co_ctx_dealloc(void* p, size_t size)
+{
+	const size_t idx = (MEM_ALIGN(size, CO_CONTEXT_CLASS_SIZE) / CO_CONTEXT_CLASS_SIZE) - 1;
+	if (idx < CO_CONTEXT_CLASS_COUNT)
+	{
+		void** tlsSpace = io_engine::getTlsValueBuff();
+		if (tlsSpace && tlsSpace[GENERATOR_CONTEXT_ALLOC_INDEX])
+		{
+			((CoContextAlloc_*)tlsSpace[GENERATOR_CONTEXT_ALLOC_INDEX])->deallocate(p, idx);
+			return;
+		}
+	}
+	free(p);
+}
+
 generator::generator()
 : __ctx(NULL), __coNext(0), __coNextEx(0), __lockStop(0), __readyQuit(false), __asyncSign(false), __yieldSign(false)
 #if (_DEBUG || DEBUG)
@@ -63,7 +177,7 @@ bool generator::_next()
 			clear_function(_baseHandler);
 			if (_notify)
 			{
-				CHECK_EXCEPTION(std::function<void()>(std::move(_notify)));
+				CHECK_EXCEPTION(small_handler<void()>(std::move(_notify)));
 			}
 			_sharedThis.reset();
 			return true;
@@ -93,7 +207,7 @@ bool generator::_next()
 	return false;
 }
 
-generator_handle generator::create(shared_strand strand, co_function handler, std::function<void()> notify)
+generator_handle generator::create(shared_strand strand, co_function handler, small_handler<void()> notify)
 {
 	void* space = _genObjAlloc->allocate();
 	generator_handle res(new(space)generator(), [](generator* p)
@@ -122,6 +236,17 @@ generator_handle generator::create(shared_strand strand, co_function handler, ge
 
 long long generator::alloc_id()
 {
+	void** tlsSpace = io_engine::getTlsValueBuff();
+	if (tlsSpace && tlsSpace[ID_BLOCK_INDEX])
+	{
+		IdBlock_* block = (IdBlock_*)tlsSpace[ID_BLOCK_INDEX];
+		if (block->_next == block->_end)
+		{
+			block->_next = _id->fetch_add(ID_BLOCK_SIZE) + 1;
+			block->_end = block->_next + ID_BLOCK_SIZE;
+		}
+		return block->_next++;
+	}
 	return ++(*_id);
 }
 
@@ -169,7 +294,7 @@ void generator::stop()
 		else
 		{
 			clear_function(_baseHandler);
-			clear_function(_notify);
+			_notify.reset();
 		}
 	} 
 	else
@@ -184,7 +309,7 @@ void generator::stop()
 			else
 			{
 				clear_function(host->_baseHandler);
-				clear_function(host->_notify);
+				host->_notify.reset();
 			}
 		}, _weakThis.lock()));
 	}
@@ -364,7 +489,8 @@ void generator::_co_usleep(long long us)
 	assert(us > 0);
 	assert(_strand->running_in_this_thread());
 	assert(_timerHandle.is_null());
-	_timerHandle = _strand->actor_timer()->timeout(us, _weakThis.lock());
+	assert(_sharedThis);
+	_timerHandle = _strand->actor_timer()->timeout(us, _sharedThis);
 }
 
 void generator::_co_dead_sleep(long long ms)
@@ -376,7 +502,8 @@ void generator::_co_dead_usleep(long long us)
 {
 	assert(_strand->running_in_this_thread());
 	assert(_timerHandle.is_null());
-	_timerHandle = _strand->actor_timer()->timeout(us, _weakThis.lock(), true);
+	assert(_sharedThis);
+	_timerHandle = _strand->actor_timer()->timeout(us, _sharedThis, true);
 }
 
 void generator::timeout_handler()
@@ -454,12 +581,67 @@ const shared_strand& generator_done_sign::self_strand()
 }
 //////////////////////////////////////////////////////////////////////////
 
-CoGo_::CoGo_(shared_strand strand, std::function<void()> ntf)
+generator_group::generator_group(const shared_strand& doneStrand, size_t num)
+:_doneSign(doneStrand), _remain(num)
+{
+}
+
+generator_group::~generator_group()
+{
+	assert(0 == _remain);
+}
+
+void generator_group::append_listen(std::function<void()> notify)
+{
+	_doneSign.append_listen(std::move(notify));
+}
+
+void generator_group::stop()
+{
+	for (size_t i = 0; i < _gens.size(); i++)
+	{
+		generator_handle gen = _gens[i].lock();
+		if (gen)
+		{
+			gen->stop();
+		}
+	}
+}
+
+size_t generator_group::size()
+{
+	return _gens.size();
+}
+
+bool generator_group::done()
+{
+	return 0 == _remain;
+}
+
+void generator_group::_one_done()
+{
+	if (0 == --_remain)
+	{
+		_all_done();
+	}
+}
+
+void generator_group::_all_done()
+{
+	_doneSign.notify_all();
+	_doneSign.self_strand()->distribute(std::bind([](generator_group_handle& group)
+	{
+		group.reset();
+	}, std::move(_sharedThis)));
+}
+//////////////////////////////////////////////////////////////////////////
+
+CoGo_::CoGo_(shared_strand strand, small_handler<void()> ntf)
 :_strand(std::move(strand)), _ntf(std::move(ntf))
 {
 }
 
-CoGo_::CoGo_(io_engine& ios, std::function<void()> ntf)
+CoGo_::CoGo_(io_engine& ios, small_handler<void()> ntf)
 :_strand(boost_strand::create(ios)), _ntf(std::move(ntf))
 {
 }
@@ -491,12 +673,12 @@ CoGo_::CoGo_(io_engine& ios, generator_done_sign& doneSign)
 }
 //////////////////////////////////////////////////////////////////////////
 
-CoCreate_::CoCreate_(shared_strand strand, std::function<void()> ntf)
+CoCreate_::CoCreate_(shared_strand strand, small_handler<void()> ntf)
 :_strand(std::move(strand)), _ntf(std::move(ntf))
 {
 }
 
-CoCreate_::CoCreate_(io_engine& ios, std::function<void()> ntf)
+CoCreate_::CoCreate_(io_engine& ios, small_handler<void()> ntf)
 :_strand(boost_strand::create(ios)), _ntf(std::move(ntf))
 {
 }
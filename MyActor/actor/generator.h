@@ -2,6 +2,8 @@
 #define __GENERATOR_H
 
 #include "msg_queue.h"
+#include "msg_spill.h"
+#include "lambda_ref.h"
 #include "actor_timer.h"
 #include "async_timer.h"
 
@@ -79,7 +81,7 @@ struct __co_context_no_capture{};
 	auto __stop = [&co_self]{\
 	DEBUG_OPERATION(co_self.__inside = false);\
 	struct co_context_tag* const pCtx = static_cast<struct co_context_tag*>(co_self.__ctx);\
-	if((void*)-1!=(void*)pCtx){_co_check_clean<co_context_tag>(co_self); delete pCtx;}\
+	if((void*)-1!=(void*)pCtx){_co_check_clean<co_context_tag>(co_self); pCtx->~co_context_tag(); generator::_co_ctx_dealloc(pCtx, co_context_space_size);}\
 	co_self.__ctx = NULL;}
 
 #define _co_stop_dealloc(__dealloc__) \
@@ -97,7 +99,7 @@ struct __co_context_no_capture{};
 
 //结束generator函数体上下文定义
 #define co_end_context(__ctx__) };\
-	if (!co_self.__ctx){co_self.__ctx = -1==co_self.__coNext ? (void*)-1 : new co_context_tag();\
+	if (!co_self.__ctx){co_self.__ctx = -1==co_self.__coNext ? (void*)-1 : new(generator::_co_ctx_alloc(co_context_space_size))co_context_tag();\
 	_co_end_context(__ctx__); _co_stop(); if(0){
 
 #define _cop(__p__) decltype(__p__)& __p__
@@ -116,7 +118,7 @@ struct __co_context_no_capture{};
 
 //结束generator函数体上下文定义，带内部变量初始化
 #define co_end_context_init(__ctx__, __capture__, ...) _co_capture __capture__:__VA_ARGS__{}};\
-	if (!co_self.__ctx){co_self.__ctx = -1==co_self.__coNext ? (void*)-1 : new co_context_tag __capture__;\
+	if (!co_self.__ctx){co_self.__ctx = -1==co_self.__coNext ? (void*)-1 : new(generator::_co_ctx_alloc(co_context_space_size))co_context_tag __capture__;\
 	_co_end_context(__ctx__); _co_stop(); if(0){
 
 //在generator结束时，做最后状态清理，可以不用
@@ -131,9 +133,9 @@ struct __co_context_no_capture{};
 #define co_ref_timer overlap_timer::timer_handle& __coTimerHandle
 #define co_ref_select co_select_sign& __selectSign
 
-//
+//generator上下文所需空间
 #define co_context_space_size sizeof(co_context_tag)
-//
+//结束generator函数体上下文定义，使用自定义分配器分配上下文空间
 #define co_end_context_alloc(__alloc__, __dealloc__, __ctx__) };\
 	if (!co_self.__ctx){co_self.__ctx = -1==co_self.__coNext ? (void*)-1 : new(__alloc__)co_context_tag();\
 	_co_end_context(__ctx__); _co_stop_dealloc(__dealloc__); if(0){
@@ -1308,6 +1310,7 @@ Ty&& co_forward(typename std::remove_reference<Ty>::type&& arg)
 class my_actor;
 class generator;
 class generator_done_sign;
+class generator_group;
 struct CoGo_;
 struct CoCreate_;
 //generator 句柄
@@ -1322,6 +1325,7 @@ class generator : public ActorTimerFace_
 {
 	friend my_actor;
 	friend io_engine;
+	friend generator_group;
 	FRIEND_SHARED_PTR(generator);
 	struct call_stack_pck
 	{
@@ -1343,7 +1347,7 @@ private:
 	generator();
 	~generator();
 public:
-	static generator_handle create(shared_strand strand, co_function handler, std::function<void()> notify = std::function<void()>());
+	static generator_handle create(shared_strand strand, co_function handler, small_handler<void()> notify = small_handler<void()>());
 	static generator_handle create(shared_strand strand, co_function handler, generator_done_sign& doneSign);
 	void run();
 	void stop();
@@ -1351,6 +1355,10 @@ public:
 	generator_handle& shared_this();
 	generator_handle& async_this();
 	const shared_bool& shared_async_sign();
+
+	/*!
+	@brief 分配全局唯一ID(与actor共用)，io_engine线程中从本线程预留的ID段中分配
+	*/
 	static long long alloc_id();
 public:
 	bool _next();
@@ -1402,6 +1410,8 @@ public:
 	void _co_dead_sleep(long long ms);
 	void _co_dead_usleep(long long us);
 	void _co_push_stack(int coNext, co_function&& handler);
+	static void* _co_ctx_alloc(size_t size);
+	static void _co_ctx_dealloc(void* p, size_t size);
 private:
 	void timeout_handler();
 	static void install(std::atomic<long long>* id);
@@ -1412,7 +1422,7 @@ private:
 	std::weak_ptr<generator> _weakThis;
 	std::shared_ptr<generator> _sharedThis;
 	co_function _baseHandler;
-	std::function<void()> _notify;
+	small_handler<void()> _notify;
 	msg_queue<call_stack_pck> _callStack;
 	shared_strand _strand;
 	ActorTimer_::timer_handle _timerHandle;
@@ -1443,6 +1453,7 @@ public:
 class generator_done_sign
 {
 	friend generator;
+	friend generator_group;
 	friend CoGo_;
 	friend CoCreate_;
 public:
@@ -1460,6 +1471,98 @@ private:
 	bool _notified;
 };
 
+//generator_group 句柄
+typedef std::shared_ptr<generator_group> generator_group_handle;
+
+/*!
+@brief 批量创建运行的一组generator，每个strand只投递一次启动任务，全部结束后统一通知
+*/
+class generator_group
+{
+private:
+	generator_group(const shared_strand& doneStrand, size_t num);
+	~generator_group();
+public:
+	/*!
+	@brief 在strands上轮流分配，创建并运行num个generator
+	@param maker 以序号i为参数，返回第i个generator函数
+	*/
+	template <typename Maker>
+	static generator_group_handle create(const std::vector<shared_strand>& strands, size_t num, Maker&& maker)
+	{
+		assert(!strands.empty());
+		generator_group_handle res(new generator_group(strands.front(), num), [](generator_group* p){ delete p; });
+		//通知在doneStrand中完成，完成前由自身持有
+		res->_sharedThis = res;
+		if (!num)
+		{
+			res->_all_done();
+			return res;
+		}
+		res->_gens.reserve(num);
+		std::vector<std::vector<generator_handle>> strandGens(strands.size() < num ? strands.size() : num);
+		for (size_t i = 0; i < strandGens.size(); i++)
+		{
+			strandGens[i].reserve(num / strandGens.size() + 1);
+		}
+		generator_group* const group = res.get();
+		for (size_t i = 0; i < num; i++)
+		{
+			const size_t si = i % strandGens.size();
+			generator_handle gen = generator::create(strands[si], maker(i), [group]()
+			{
+				group->_one_done();
+			});
+			res->_gens.push_back(gen);
+			strandGens[si].push_back(std::move(gen));
+		}
+		for (size_t i = 0; i < strandGens.size(); i++)
+		{
+			strands[i]->post(std::bind([](std::vector<generator_handle>& gens)
+			{
+				for (size_t j = 0; j < gens.size(); j++)
+				{
+					generator_handle& gen = gens[j];
+					assert(!gen->_isRun);
+					DEBUG_OPERATION(gen->_isRun = true);
+					gen->_revert_this(gen)->_next();
+				}
+			}, std::move(strandGens[i])));
+		}
+		return res;
+	}
+
+	/*!
+	@brief 全部generator结束后通知
+	*/
+	void append_listen(std::function<void()> notify);
+
+	/*!
+	@brief 结束全部generator
+	*/
+	void stop();
+
+	/*!
+	@brief generator个数
+	*/
+	size_t size();
+
+	/*!
+	@brief 是否全部结束
+	*/
+	bool done();
+private:
+	void _one_done();
+	void _all_done();
+private:
+	//只弱引用，结束的generator可以及时释放
+	std::vector<std::weak_ptr<generator>> _gens;
+	generator_group_handle _sharedThis;
+	generator_done_sign _doneSign;
+	std::atomic<size_t> _remain;
+	NONE_COPY(generator_group);
+};
+
 HAS_MEMBER_FUNC(_co_clean)
 
 template <typename Context, bool hasCoClean>
@@ -1507,8 +1610,8 @@ private:
 
 struct CoGo_
 {
-	CoGo_(shared_strand strand, std::function<void()> ntf = std::function<void()>());
-	CoGo_(io_engine& ios, std::function<void()> ntf = std::function<void()>());
+	CoGo_(shared_strand strand, small_handler<void()> ntf = small_handler<void()>());
+	CoGo_(io_engine& ios, small_handler<void()> ntf = small_handler<void()>());
 	CoGo_(shared_strand strand, generator_done_sign& doneSign);
 	CoGo_(io_engine& ios, generator_done_sign& doneSign);
 
@@ -1521,13 +1624,13 @@ struct CoGo_
 	}
 
 	shared_strand _strand;
-	std::function<void()> _ntf;
+	small_handler<void()> _ntf;
 };
 
 struct CoCreate_
 {
-	CoCreate_(shared_strand strand, std::function<void()> ntf = std::function<void()>());
-	CoCreate_(io_engine& ios, std::function<void()> ntf = std::function<void()>());
+	CoCreate_(shared_strand strand, small_handler<void()> ntf = small_handler<void()>());
+	CoCreate_(io_engine& ios, small_handler<void()> ntf = small_handler<void()>());
 	CoCreate_(shared_strand strand, generator_done_sign& doneSign);
 	CoCreate_(io_engine& ios, generator_done_sign& doneSign);
 
@@ -1538,7 +1641,7 @@ struct CoCreate_
 	}
 
 	shared_strand _strand;
-	std::function<void()> _ntf;
+	small_handler<void()> _ntf;
 };
 
 struct CoTimeout_
@@ -3452,6 +3555,26 @@ public:
 		return std::make_shared<co_msg_buffer>(strand, poolSize);
 	}
 public:
+	/*!
+	@brief 启用溢出到磁盘，内存中缓存的消息超过memBytes字节后，后续消息序列化到段文件中，消费时按序读回(须在使用前调用)
+	@param pathPrefix 段文件路径前缀
+	@param memBytes 内存中缓存消息的字节预算(按Serializer::size计)
+	@param segmentBytes 单个段文件大小
+	*/
+	template <typename Serializer = msg_spill_serializer<msg_type>>
+	void enable_spill(const std::string& pathPrefix, size_t memBytes, size_t segmentBytes = 64 * 1024 * 1024)
+	{
+		_msgBuff.template enable_spill<Serializer>(pathPrefix, memBytes, segmentBytes);
+	}
+
+	/*!
+	@brief 当前溢出到磁盘中的消息数
+	*/
+	size_t spill_size()
+	{
+		assert(_strand->running_in_this_thread());
+		return _msgBuff.spill_size();
+	}
 	template <typename... Args>
 	void send(Args&&... msg)
 	{
@@ -4222,7 +4345,7 @@ private:
 	}
 private:
 	shared_strand _strand;
-	msg_queue<msg_type> _msgBuff;
+	spill_msg_queue<msg_type> _msgBuff;
 	reusable_mem _alloc;
 	msg_list<CoNotifyHandlerFace_*> _waitQueue;
 	bool _closed;
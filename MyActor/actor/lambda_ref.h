@@ -743,4 +743,200 @@ WrapLocalHandler_<Handler, R(Types...)> wrap_local_handler(Handler&& handler)
 	return WrapLocalHandler_<Handler, R(Types...)>(bool(), handler);
 }
 
+
+//small_handler内部缓冲区大小，能放下trig_notifer/trig_once_notifer及投递到strand的actor_handle捕获(含虚表指针)
+#define SMALL_HANDLER_SPACE (8 * sizeof(void*))
+
+template <typename... _Types>
+struct SmallHandlerFace_;
+template <typename... _Types>
+struct SmallHandlerInvoker_;
+
+template <typename _Rt, typename... _Types>
+struct SmallHandlerFace_<_Rt(_Types...)>
+{
+	virtual _Rt invoke(_Types... args) = 0;
+	virtual SmallHandlerFace_* move_to(void* space) = 0;
+	virtual void destroy(bool local) = 0;
+};
+
+template <typename Handler, typename _Rt, typename... _Types>
+struct SmallHandlerInvoker_<Handler, _Rt(_Types...)> : public SmallHandlerFace_<_Rt(_Types...)>
+{
+	typedef SmallHandlerFace_<_Rt(_Types...)> face_type;
+
+	template <typename H>
+	SmallHandlerInvoker_(bool, H&& h)
+		:_handler(std::forward<H>(h)) {}
+
+	_Rt invoke(_Types... args)
+	{
+		return agent_result<_Rt>::invoke(_handler, std::forward<_Types>(args)...);
+	}
+
+	face_type* move_to(void* space)
+	{
+		face_type* res = new(space)SmallHandlerInvoker_(bool(), std::move(_handler));
+		this->~SmallHandlerInvoker_();
+		return res;
+	}
+
+	void destroy(bool local)
+	{
+		if (local)
+		{
+			this->~SmallHandlerInvoker_();
+		}
+		else
+		{
+			delete this;
+		}
+	}
+
+	Handler _handler;
+	NONE_COPY(SmallHandlerInvoker_);
+};
+
+template <typename... _Types>
+class small_handler;
+
+/*!
+@brief 只可转移的回调函数，捕获不超过SMALL_HANDLER_SPACE时不申请堆内存，用于替代控制路径上的std::function；
+不可拷贝，投递时需std::move进闭包
+*/
+template <typename _Rt, typename... _Types>
+class small_handler<_Rt(_Types...)>
+{
+	typedef SmallHandlerFace_<_Rt(_Types...)> face_type;
+public:
+	small_handler()
+		:_func(NULL) {}
+
+	small_handler(std::nullptr_t)
+		:_func(NULL) {}
+
+	template <typename Handler, typename = typename std::enable_if<!std::is_same<RM_CREF(Handler), small_handler>::value>::type>
+	small_handler(Handler&& h)
+		: _func(NULL)
+	{
+		if (!is_null(h))
+		{
+			set(std::forward<Handler>(h));
+		}
+	}
+
+	small_handler(small_handler&& s)
+		:_func(NULL)
+	{
+		move_from(s);
+	}
+
+	~small_handler()
+	{
+		reset();
+	}
+
+	void operator=(small_handler&& s)
+	{
+		if (this != &s)
+		{
+			reset();
+			move_from(s);
+		}
+	}
+
+	void operator=(std::nullptr_t)
+	{
+		reset();
+	}
+public:
+	_Rt operator()(_Types... args) const
+	{
+		assert(_func);
+		return _func->invoke(std::forward<_Types>(args)...);
+	}
+
+	explicit operator bool() const
+	{
+		return NULL != _func;
+	}
+
+	bool empty() const
+	{
+		return NULL == _func;
+	}
+
+	void reset()
+	{
+		if (_func)
+		{
+			_func->destroy(is_local());
+			_func = NULL;
+		}
+	}
+
+	void swap(small_handler& s)
+	{
+		small_handler t(std::move(s));
+		s = std::move(*this);
+		*this = std::move(t);
+	}
+private:
+	bool is_local() const
+	{
+		return (const void*)_func == (const void*)_space;
+	}
+
+	void move_from(small_handler& s)
+	{
+		assert(!_func);
+		if (s._func)
+		{
+			_func = s.is_local() ? s._func->move_to(_space) : s._func;
+			s._func = NULL;
+		}
+	}
+
+	template <typename Handler>
+	void set(Handler&& h)
+	{
+		typedef SmallHandlerInvoker_<typename std::decay<Handler>::type, _Rt(_Types...)> invoker_type;
+		set<invoker_type>(std::forward<Handler>(h), std::integral_constant<bool, sizeof(invoker_type) <= SMALL_HANDLER_SPACE && std::alignment_of<invoker_type>::value <= sizeof(void*)>());
+	}
+
+	template <typename Invoker, typename Handler>
+	void set(Handler&& h, std::true_type)
+	{
+		_func = new(_space)Invoker(bool(), std::forward<Handler>(h));
+	}
+
+	template <typename Invoker, typename Handler>
+	void set(Handler&& h, std::false_type)
+	{
+		_func = new Invoker(bool(), std::forward<Handler>(h));
+	}
+
+	template <typename Handler>
+	static bool is_null(const Handler&)
+	{
+		return false;
+	}
+
+	template <typename Sign>
+	static bool is_null(const std::function<Sign>& h)
+	{
+		return !h;
+	}
+
+	template <typename R, typename... Args>
+	static bool is_null(R(*h)(Args...))
+	{
+		return !h;
+	}
+private:
+	face_type* _func;
+	__space_align char _space[SMALL_HANDLER_SPACE];
+	NONE_COPY(small_handler);
+};
+
 #endif
\ No newline at end of file
@@ -5,6 +5,7 @@
 #include <map>
 #include <set>
 #include <list>
+#include <vector>
 
 template <typename T, typename TAlloc = mem_alloc<>>
 class msg_queue
@@ -231,6 +232,262 @@ public:
 		:msg_queue<void, TAlloc>(poolSize) {}
 };
 
+/*!
+@brief 多优先级通道消息队列，通道0优先级最高，未启用时只有一个通道，与msg_queue相同；
+push_back进入默认通道，push_lane进入指定通道，push_front放回上次pop_front取出消息的通道前端；
+front/pop_front总是取最高优先级非空通道，连续从高优先级通道取出starveLimit条后，
+若更低的通道有消息则先取一条低优先级消息，starveLimit为0时严格按优先级
+*/
+template <typename T>
+class lane_msg_queue
+{
+public:
+	lane_msg_queue(size_t poolSize = sizeof(void*))
+		:_queue(poolSize), _poolSize(poolSize), _size(0), _defaultLane(0), _starveLimit(0), _burst(0), _lastLane(0) {}
+
+	~lane_msg_queue()
+	{
+		clear();
+		free_lanes();
+	}
+
+	/*!
+	@brief 设置通道，已排队的消息按当前优先级顺序并入新的默认通道
+	@param laneNum 通道数，1为关闭优先级
+	@param defaultLane push_back进入的通道
+	@param starveLimit 低优先级防饿死阈值
+	*/
+	void enable_lanes(size_t laneNum, size_t defaultLane, size_t starveLimit)
+	{
+		assert(laneNum && defaultLane < laneNum);
+		if (!_lanes.empty())
+		{
+			msg_queue<T> merged(_poolSize);
+			for (size_t i = 0; i < _lanes.size(); i++)
+			{
+				msg_queue<T>& lane = *_lanes[i];
+				while (!lane.empty())
+				{
+					merged.push_back(std::move(lane.front()));
+					lane.pop_front();
+				}
+			}
+			while (!merged.empty())
+			{
+				_queue.push_back(std::move(merged.front()));
+				merged.pop_front();
+			}
+			free_lanes();
+		}
+		if (laneNum > 1)
+		{
+			_lanes.resize(laneNum);
+			for (size_t i = 0; i < laneNum; i++)
+			{
+				_lanes[i] = i == defaultLane ? &_queue : new msg_queue<T>(_poolSize);
+			}
+		}
+		_defaultLane = defaultLane;
+		_starveLimit = starveLimit;
+		_burst = 0;
+		_lastLane = defaultLane;
+	}
+
+	bool same_lanes(size_t laneNum, size_t defaultLane, size_t starveLimit) const
+	{
+		if (_lanes.empty())
+		{
+			return 1 == laneNum;
+		}
+		return laneNum == _lanes.size() && defaultLane == _defaultLane && starveLimit == _starveLimit;
+	}
+
+	size_t lane_num() const
+	{
+		return _lanes.empty() ? 1 : _lanes.size();
+	}
+
+	template <typename... Args>
+	void push_back(Args&&... args)
+	{
+		_queue.push_back(std::forward<Args>(args)...);
+		_size++;
+	}
+
+	/*!
+	@brief 放入指定通道，超出通道数的放入最低优先级通道
+	*/
+	template <typename... Args>
+	void push_lane(size_t lane, Args&&... args)
+	{
+		if (_lanes.empty())
+		{
+			_queue.push_back(std::forward<Args>(args)...);
+		}
+		else
+		{
+			_lanes[lane < _lanes.size() ? lane : _lanes.size() - 1]->push_back(std::forward<Args>(args)...);
+		}
+		_size++;
+	}
+
+	/*!
+	@brief 放回上次pop_front取出消息所在通道的前端，用于回流刚取出的消息
+	*/
+	template <typename... Args>
+	void push_front(Args&&... args)
+	{
+		if (_lanes.empty())
+		{
+			_queue.push_front(std::forward<Args>(args)...);
+		}
+		else
+		{
+			_lanes[_lastLane]->push_front(std::forward<Args>(args)...);
+		}
+		_size++;
+	}
+
+	T& front()
+	{
+		assert(_size);
+		if (_lanes.empty())
+		{
+			return _queue.front();
+		}
+		size_t top;
+		return _lanes[pick(top)]->front();
+	}
+
+	void pop_front()
+	{
+		assert(_size);
+		_size--;
+		if (_lanes.empty())
+		{
+			_queue.pop_front();
+			return;
+		}
+		size_t top;
+		const size_t lane = pick(top);
+		_lanes[lane]->pop_front();
+		_lastLane = lane;
+		if (lane == top && _starveLimit && lower_waiting(top))
+		{
+			_burst++;
+		}
+		else
+		{
+			_burst = 0;
+		}
+	}
+
+	size_t size() const
+	{
+		return _size;
+	}
+
+	bool empty() const
+	{
+		return !_size;
+	}
+
+	void clear()
+	{
+		if (_lanes.empty())
+		{
+			_queue.clear();
+		}
+		else
+		{
+			for (size_t i = 0; i < _lanes.size(); i++)
+			{
+				_lanes[i]->clear();
+			}
+		}
+		_size = 0;
+		_burst = 0;
+		_lastLane = _defaultLane;
+	}
+
+	void expand_fixed(size_t fixedSize)
+	{
+		if (fixedSize > _poolSize)
+		{
+			_poolSize = fixedSize;
+		}
+		_queue.expand_fixed(fixedSize);
+		for (size_t i = 0; i < _lanes.size(); i++)
+		{
+			_lanes[i]->expand_fixed(fixedSize);
+		}
+	}
+
+	size_t fixed_size()
+	{
+		return _queue.fixed_size();
+	}
+private:
+	/*!
+	@brief 选出下一条消息所在通道，top返回最高优先级非空通道
+	*/
+	size_t pick(size_t& top)
+	{
+		top = 0;
+		while (_lanes[top]->empty())
+		{
+			top++;
+			assert(top < _lanes.size());
+		}
+		if (_starveLimit && _burst >= _starveLimit)
+		{
+			for (size_t i = top + 1; i < _lanes.size(); i++)
+			{
+				if (!_lanes[i]->empty())
+				{
+					return i;
+				}
+			}
+		}
+		return top;
+	}
+
+	bool lower_waiting(size_t top)
+	{
+		for (size_t i = top + 1; i < _lanes.size(); i++)
+		{
+			if (!_lanes[i]->empty())
+			{
+				return true;
+			}
+		}
+		return false;
+	}
+
+	void free_lanes()
+	{
+		for (size_t i = 0; i < _lanes.size(); i++)
+		{
+			if (_lanes[i] != &_queue)
+			{
+				assert(_lanes[i]->empty());
+				delete _lanes[i];
+			}
+		}
+		_lanes.clear();
+	}
+private:
+	msg_queue<T> _queue;
+	std::vector<msg_queue<T>*> _lanes;
+	size_t _poolSize;
+	size_t _size;
+	size_t _defaultLane;
+	size_t _starveLimit;
+	size_t _burst;
+	size_t _lastLane;
+	NONE_COPY(lane_msg_queue);
+};
+
 template <typename T>
 class node_queue
 {
@@ -1170,5 +1427,235 @@ public:
 		return *this;
 	}
 };
+//////////////////////////////////////////////////////////////////////////
+
+/*!
+@brief 以非0整数为键的开放寻址哈希表，元素不超过InlineN个时存放在内部数组中顺序查找，
+超过后转入2的幂长度线性探测表，下标取键乘法散列后的低位
+*/
+template <typename Tval, size_t InlineN = 4>
+class flat_id_map
+{
+	struct node
+	{
+		node()
+		:_key(0) {}
+
+		unsigned _key;
+		Tval _value;
+	};
+public:
+	flat_id_map()
+		:_table(NULL), _mask(0), _size(0) {}
+
+	~flat_id_map()
+	{
+		delete[] _table;
+	}
+public:
+	/*!
+	@brief 查找键对应的值，不存在返回NULL
+	*/
+	Tval* find(const unsigned key)
+	{
+		assert(key);
+		if (!_table)
+		{
+			for (size_t i = 0; i < _size; i++)
+			{
+				if (key == _inline[i]._key)
+				{
+					return &_inline[i]._value;
+				}
+			}
+			return NULL;
+		}
+		for (size_t i = slot(key);; i = (i + 1) & _mask)
+		{
+			if (key == _table[i]._key)
+			{
+				return &_table[i]._value;
+			}
+			if (!_table[i]._key)
+			{
+				return NULL;
+			}
+		}
+	}
+
+	/*!
+	@brief 查找键对应的值，不存在时插入默认值，返回的引用在下次插入前有效
+	*/
+	Tval& insert(const unsigned key)
+	{
+		Tval* const res = find(key);
+		if (res)
+		{
+			return *res;
+		}
+		if (!_table)
+		{
+			if (_size < InlineN)
+			{
+				_inline[_size]._key = key;
+				return _inline[_size++]._value;
+			}
+			rehash(4 * InlineN);
+			for (size_t i = 0; i < _size; i++)
+			{
+				node& nd = place(_inline[i]._key);
+				nd._value = std::move(_inline[i]._value);
+				_inline[i]._key = 0;
+				_inline[i]._value = Tval();
+			}
+		}
+		else if (2 * (_size + 1) > _mask + 1)
+		{
+			rehash(2 * (_mask + 1));
+		}
+		_size++;
+		return place(key)._value;
+	}
+
+	/*!
+	@brief 删除键，返回是否存在
+	*/
+	bool erase(const unsigned key)
+	{
+		assert(key);
+		if (!_table)
+		{
+			for (size_t i = 0; i < _size; i++)
+			{
+				if (key == _inline[i]._key)
+				{
+					_size--;
+					if (i != _size)
+					{
+						_inline[i]._key = _inline[_size]._key;
+						_inline[i]._value = std::move(_inline[_size]._value);
+					}
+					_inline[_size]._key = 0;
+					_inline[_size]._value = Tval();
+					return true;
+				}
+			}
+			return false;
+		}
+		size_t i = slot(key);
+		while (key != _table[i]._key)
+		{
+			if (!_table[i]._key)
+			{
+				return false;
+			}
+			i = (i + 1) & _mask;
+		}
+		//后移删除，把后续探测链上的元素前移填补空位
+		for (size_t j = (i + 1) & _mask; _table[j]._key; j = (j + 1) & _mask)
+		{
+			const size_t k = slot(_table[j]._key);
+			if (i <= j ? (k <= i || k > j) : (k <= i && k > j))
+			{
+				_table[i]._key = _table[j]._key;
+				_table[i]._value = std::move(_table[j]._value);
+				i = j;
+			}
+		}
+		_table[i]._key = 0;
+		_table[i]._value = Tval();
+		_size--;
+		return true;
+	}
+
+	/*!
+	@brief 遍历所有元素 h(key, value)
+	*/
+	template <typename Handler>
+	void for_each(Handler&& h)
+	{
+		if (!_table)
+		{
+			for (size_t i = 0; i < _size; i++)
+			{
+				h(_inline[i]._key, _inline[i]._value);
+			}
+			return;
+		}
+		for (size_t i = 0; i <= _mask; i++)
+		{
+			if (_table[i]._key)
+			{
+				h(_table[i]._key, _table[i]._value);
+			}
+		}
+	}
+
+	void clear()
+	{
+		for (size_t i = 0; i < InlineN; i++)
+		{
+			_inline[i]._key = 0;
+			_inline[i]._value = Tval();
+		}
+		delete[] _table;
+		_table = NULL;
+		_mask = 0;
+		_size = 0;
+	}
+
+	size_t size() const
+	{
+		return _size;
+	}
+
+	bool empty() const
+	{
+		return !_size;
+	}
+private:
+	/*!
+	@brief 键的所有位都参与散列，避免高位不同低位相同的键落入同一探测链
+	*/
+	size_t slot(const unsigned key) const
+	{
+		unsigned h = key * 2654435769u;
+		h ^= h >> 16;
+		return h & _mask;
+	}
+
+	node& place(const unsigned key)
+	{
+		size_t i = slot(key);
+		while (_table[i]._key)
+		{
+			i = (i + 1) & _mask;
+		}
+		_table[i]._key = key;
+		return _table[i];
+	}
+
+	void rehash(const size_t capacity)
+	{
+		node* const oldTable = _table;
+		const size_t oldCapacity = _table ? _mask + 1 : 0;
+		_table = new node[capacity];
+		_mask = capacity - 1;
+		for (size_t i = 0; i < oldCapacity; i++)
+		{
+			if (oldTable[i]._key)
+			{
+				place(oldTable[i]._key)._value = std::move(oldTable[i]._value);
+			}
+		}
+		delete[] oldTable;
+	}
+private:
+	node _inline[InlineN];
+	node* _table;
+	size_t _mask;
+	size_t _size;
+	NONE_COPY(flat_id_map);
+};
 
 #endif
\ No newline at end of file
@@ -0,0 +1,198 @@
+#include "msg_spill.h"
+#ifdef WIN32
+#include <Windows.h>
+#elif __linux__
+#include <fcntl.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#endif
+
+//记录头，保存记录长度
+#define SPILL_RECORD_HEAD MEM_ALIGN(sizeof(size_t), sizeof(void*))
+
+//段文件名冲突时最多尝试的序号个数
+#define SPILL_OPEN_RETRY 1024
+
+msg_spill_file::msg_spill_file(const std::string& pathPrefix, size_t segmentBytes)
+:_pathPrefix(pathPrefix), _segmentBytes(MEM_ALIGN(segmentBytes, 4096)), _segmentCount(0), _size(0), _segments(4)
+{
+	assert(segmentBytes);
+}
+
+msg_spill_file::~msg_spill_file()
+{
+	clear();
+}
+
+char* msg_spill_file::append_begin(size_t size)
+{
+	const size_t needSize = SPILL_RECORD_HEAD + MEM_ALIGN(size, sizeof(void*));
+	segment* seg = _segments.empty() ? NULL : _segments.back();
+	if (!seg || seg->_writePos + needSize > seg->_length)
+	{
+		seg = open_segment(needSize > _segmentBytes ? MEM_ALIGN(needSize, 4096) : _segmentBytes);
+		if (!seg)
+		{
+			return NULL;
+		}
+		_segments.push_back(seg);
+	}
+	return seg->_buff + seg->_writePos + SPILL_RECORD_HEAD;
+}
+
+void msg_spill_file::append_end(size_t size)
+{
+	segment* seg = _segments.back();
+	*as_ptype<size_t>(seg->_buff + seg->_writePos) = size;
+	seg->_writePos += SPILL_RECORD_HEAD + MEM_ALIGN(size, sizeof(void*));
+	_size++;
+}
+
+const char* msg_spill_file::front(size_t& size)
+{
+	assert(_size);
+	segment* seg = _segments.front();
+	assert(seg->_readPos < seg->_writePos);
+	size = *as_ptype<size_t>(seg->_buff + seg->_readPos);
+	return seg->_buff + seg->_readPos + SPILL_RECORD_HEAD;
+}
+
+void msg_spill_file::pop_front()
+{
+	assert(_size);
+	segment* seg = _segments.front();
+	seg->_readPos += SPILL_RECORD_HEAD + MEM_ALIGN(*as_ptype<size_t>(seg->_buff + seg->_readPos), sizeof(void*));
+	_size--;
+	if (seg->_readPos == seg->_writePos && (_segments.size() > 1 || !_size))
+	{
+		_segments.pop_front();
+		close_segment(seg);
+	}
+}
+
+size_t msg_spill_file::size() const
+{
+	return _size;
+}
+
+bool msg_spill_file::empty() const
+{
+	return !_size;
+}
+
+void msg_spill_file::clear()
+{
+	while (!_segments.empty())
+	{
+		close_segment(_segments.front());
+		_segments.pop_front();
+	}
+	_size = 0;
+}
+
+#ifdef WIN32
+
+msg_spill_file::segment* msg_spill_file::open_segment(size_t length)
+{
+	//CREATE_NEW独占创建，名字冲突时换下一个序号
+	HANDLE fileHandle = INVALID_HANDLE_VALUE;
+	for (int i = 0; i < SPILL_OPEN_RETRY && INVALID_HANDLE_VALUE == fileHandle; i++)
+	{
+		char path[32];
+		sprintf_s(path, ".%llu.spill", (unsigned long long)_segmentCount++);
+		fileHandle = CreateFileA((_pathPrefix + path).c_str(), GENERIC_READ | GENERIC_WRITE, 0, NULL, CREATE_NEW,
+			FILE_ATTRIBUTE_TEMPORARY | FILE_FLAG_DELETE_ON_CLOSE | FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+		if (INVALID_HANDLE_VALUE == fileHandle && ERROR_FILE_EXISTS != GetLastError())
+		{
+			return NULL;
+		}
+	}
+	if (INVALID_HANDLE_VALUE == fileHandle)
+	{
+		return NULL;
+	}
+	HANDLE mapHandle = CreateFileMappingA(fileHandle, NULL, PAGE_READWRITE, (DWORD)((unsigned long long)length >> 32), (DWORD)length, NULL);
+	if (!mapHandle)
+	{
+		CloseHandle(fileHandle);
+		return NULL;
+	}
+	void* buff = MapViewOfFile(mapHandle, FILE_MAP_ALL_ACCESS, 0, 0, length);
+	if (!buff)
+	{
+		CloseHandle(mapHandle);
+		CloseHandle(fileHandle);
+		return NULL;
+	}
+	segment* seg = new segment;
+	seg->_buff = (char*)buff;
+	seg->_length = length;
+	seg->_writePos = 0;
+	seg->_readPos = 0;
+	seg->_fileHandle = fileHandle;
+	seg->_mapHandle = mapHandle;
+	return seg;
+}
+
+void msg_spill_file::close_segment(segment* seg)
+{
+	UnmapViewOfFile(seg->_buff);
+	CloseHandle(seg->_mapHandle);
+	CloseHandle(seg->_fileHandle);
+	delete seg;
+}
+
+#elif __linux__
+
+msg_spill_file::segment* msg_spill_file::open_segment(size_t length)
+{
+	//O_EXCL独占创建，同前缀的其它缓冲正在使用的段文件不会被截断，名字冲突时换下一个序号
+	std::string fileName;
+	int fd = -1;
+	for (int i = 0; i < SPILL_OPEN_RETRY && -1 == fd; i++)
+	{
+		char path[32];
+		snprintf(path, sizeof(path), ".%llu.spill", (unsigned long long)_segmentCount++);
+		fileName = _pathPrefix + path;
+		fd = open(fileName.c_str(), O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC, 0600);
+		if (-1 == fd && EEXIST != errno)
+		{
+			return NULL;
+		}
+	}
+	if (-1 == fd)
+	{
+		return NULL;
+	}
+	//文件只在本进程内使用，映射后立即删除目录项，进程退出时自动回收
+	unlink(fileName.c_str());
+	if (0 != ftruncate(fd, length))
+	{
+		close(fd);
+		return NULL;
+	}
+	void* buff = mmap(NULL, length, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	if (MAP_FAILED == buff)
+	{
+		close(fd);
+		return NULL;
+	}
+	madvise(buff, length, MADV_SEQUENTIAL);
+	segment* seg = new segment;
+	seg->_buff = (char*)buff;
+	seg->_length = length;
+	seg->_writePos = 0;
+	seg->_readPos = 0;
+	seg->_fd = fd;
+	return seg;
+}
+
+void msg_spill_file::close_segment(segment* seg)
+{
+	munmap(seg->_buff, seg->_length);
+	close(seg->_fd);
+	delete seg;
+}
+
+#endif
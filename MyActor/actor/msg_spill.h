@@ -0,0 +1,415 @@
+#ifndef __MSG_SPILL_H
+#define __MSG_SPILL_H
+
+#include <string>
+#include <tuple>
+#include "msg_queue.h"
+
+/*!
+@brief 只追加写入的内存映射段文件组，记录按写入顺序读出，读完的段文件立即释放
+*/
+class msg_spill_file
+{
+	struct segment
+	{
+		char* _buff;
+		size_t _length;
+		size_t _writePos;
+		size_t _readPos;
+#ifdef WIN32
+		void* _fileHandle;
+		void* _mapHandle;
+#elif __linux__
+		int _fd;
+#endif
+	};
+public:
+	msg_spill_file(const std::string& pathPrefix, size_t segmentBytes);
+	~msg_spill_file();
+public:
+	/*!
+	@brief 申请一段写入空间，失败返回NULL
+	*/
+	char* append_begin(size_t size);
+
+	/*!
+	@brief 确认写入append_begin申请的空间
+	*/
+	void append_end(size_t size);
+
+	/*!
+	@brief 读取最早写入的记录
+	*/
+	const char* front(size_t& size);
+
+	/*!
+	@brief 弹出最早写入的记录
+	*/
+	void pop_front();
+
+	size_t size() const;
+	bool empty() const;
+	void clear();
+private:
+	segment* open_segment(size_t length);
+	void close_segment(segment* seg);
+private:
+	std::string _pathPrefix;
+	size_t _segmentBytes;
+	size_t _segmentCount;
+	size_t _size;
+	msg_queue<segment*> _segments;
+	NONE_COPY(msg_spill_file);
+};
+
+template <typename T>
+struct MsgSpillTrivial_
+{
+#if (_MSC_VER || __GNUC__ >= 5)
+	enum { value = std::is_trivially_copyable<T>::value };
+#else
+	enum { value = __has_trivial_copy(T) && __has_trivial_destructor(T) };
+#endif
+};
+
+/*!
+@brief 消息溢出到磁盘时的序列化方式，默认只支持可平凡复制的类型，其它类型需特化
+size() 序列化后的字节数
+save() 序列化到buff，返回写入后的位置
+load() 从buff反序列化，并将buff推进到下一个位置
+*/
+template <typename T>
+struct msg_spill_serializer
+{
+	static_assert(MsgSpillTrivial_<T>::value, "specialize msg_spill_serializer<T> for non-trivially-copyable type");
+
+	static size_t size(const T&)
+	{
+		return sizeof(T);
+	}
+
+	static char* save(const T& msg, char* buff)
+	{
+		memcpy(buff, &msg, sizeof(T));
+		return buff + sizeof(T);
+	}
+
+	static T load(const char*& buff)
+	{
+		T msg;
+		memcpy(&msg, buff, sizeof(T));
+		buff += sizeof(T);
+		return msg;
+	}
+};
+
+template <>
+struct msg_spill_serializer<std::string>
+{
+	static size_t size(const std::string& msg)
+	{
+		return sizeof(size_t) + msg.size();
+	}
+
+	static char* save(const std::string& msg, char* buff)
+	{
+		const size_t length = msg.size();
+		memcpy(buff, &length, sizeof(size_t));
+		memcpy(buff + sizeof(size_t), msg.data(), length);
+		return buff + sizeof(size_t) + length;
+	}
+
+	static std::string load(const char*& buff)
+	{
+		size_t length;
+		memcpy(&length, buff, sizeof(size_t));
+		std::string msg(buff + sizeof(size_t), length);
+		buff += sizeof(size_t) + length;
+		return msg;
+	}
+};
+
+template <typename... Types>
+struct msg_spill_serializer<std::tuple<Types...>>
+{
+	static size_t size(const std::tuple<Types...>& msg)
+	{
+		return _size(msg, std::integral_constant<size_t, 0>());
+	}
+
+	static char* save(const std::tuple<Types...>& msg, char* buff)
+	{
+		return _save(msg, buff, std::integral_constant<size_t, 0>());
+	}
+
+	static std::tuple<Types...> load(const char*& buff)
+	{
+		//部分编译器不保证列表初始化从左到右求值，逐个字段读到临时对象后再构造
+		return _load(buff, std::integral_constant<size_t, 0>());
+	}
+private:
+	template <typename... Loaded>
+	static std::tuple<Types...> _load(const char*&, std::integral_constant<size_t, sizeof...(Types)>, Loaded&&... loaded)
+	{
+		return std::tuple<Types...>(std::forward<Loaded>(loaded)...);
+	}
+
+	template <size_t I, typename... Loaded>
+	static std::tuple<Types...> _load(const char*& buff, std::integral_constant<size_t, I>, Loaded&&... loaded)
+	{
+		typedef typename std::tuple_element<I, std::tuple<Types...>>::type type;
+		type msg = msg_spill_serializer<type>::load(buff);
+		return _load(buff, std::integral_constant<size_t, I + 1>(), std::forward<Loaded>(loaded)..., std::move(msg));
+	}
+
+	static size_t _size(const std::tuple<Types...>&, std::integral_constant<size_t, sizeof...(Types)>)
+	{
+		return 0;
+	}
+
+	template <size_t I>
+	static size_t _size(const std::tuple<Types...>& msg, std::integral_constant<size_t, I>)
+	{
+		typedef typename std::tuple_element<I, std::tuple<Types...>>::type type;
+		return msg_spill_serializer<type>::size(std::get<I>(msg)) + _size(msg, std::integral_constant<size_t, I + 1>());
+	}
+
+	static char* _save(const std::tuple<Types...>&, char* buff, std::integral_constant<size_t, sizeof...(Types)>)
+	{
+		return buff;
+	}
+
+	template <size_t I>
+	static char* _save(const std::tuple<Types...>& msg, char* buff, std::integral_constant<size_t, I>)
+	{
+		typedef typename std::tuple_element<I, std::tuple<Types...>>::type type;
+		return _save(msg, msg_spill_serializer<type>::save(std::get<I>(msg), buff), std::integral_constant<size_t, I + 1>());
+	}
+};
+
+template <typename T>
+struct MsgSpillFace_
+{
+	virtual ~MsgSpillFace_() {}
+	virtual bool push(const T& msg) = 0;
+	virtual size_t pop(msg_queue<T>& dst) = 0;
+	virtual size_t bytes(const T& msg) = 0;
+	virtual size_t size() = 0;
+	virtual void clear() = 0;
+};
+
+template <typename T, typename Serializer>
+struct MsgSpill_ : public MsgSpillFace_<T>
+{
+	MsgSpill_(const std::string& pathPrefix, size_t segmentBytes)
+		:_file(pathPrefix, segmentBytes) {}
+
+	bool push(const T& msg)
+	{
+		const size_t length = Serializer::size(msg);
+		char* buff = _file.append_begin(length);
+		if (!buff)
+		{
+			return false;
+		}
+		DEBUG_OPERATION(char* end = ) Serializer::save(msg, buff);
+		assert(end == buff + length);
+		_file.append_end(length);
+		return true;
+	}
+
+	size_t pop(msg_queue<T>& dst)
+	{
+		size_t length = 0;
+		const char* buff = _file.front(length);
+		DEBUG_OPERATION(const char* begin = buff);
+		dst.push_back(Serializer::load(buff));
+		assert(buff == begin + length);
+		_file.pop_front();
+		return length;
+	}
+
+	size_t bytes(const T& msg)
+	{
+		return Serializer::size(msg);
+	}
+
+	size_t size()
+	{
+		return _file.size();
+	}
+
+	void clear()
+	{
+		_file.clear();
+	}
+
+	msg_spill_file _file;
+};
+
+/*!
+@brief 可溢出到磁盘的消息队列，未启用溢出时与msg_queue相同；
+内存中消息的字节数(按序列化大小计)超过预算后，后续消息序列化到段文件，内存中消息取完后再按序读回
+*/
+template <typename T>
+class spill_msg_queue
+{
+public:
+	spill_msg_queue(size_t poolSize = sizeof(void*))
+		:_memQueue(poolSize), _spill(NULL), _memBytes(0), _memMaxBytes(0) {}
+
+	~spill_msg_queue()
+	{
+		delete _spill;
+	}
+
+	/*!
+	@brief 启用溢出，须在队列为空时调用
+	@param pathPrefix 段文件路径前缀
+	@param memBytes 内存中缓存消息的字节预算(按Serializer::size计)，至少缓存一条消息
+	@param segmentBytes 单个段文件大小
+	*/
+	template <typename Serializer = msg_spill_serializer<T>>
+	void enable_spill(const std::string& pathPrefix, size_t memBytes, size_t segmentBytes)
+	{
+		assert(empty());
+		delete _spill;
+		_spill = new MsgSpill_<T, Serializer>(pathPrefix, segmentBytes);
+		_memSizes.clear();
+		_memBytes = 0;
+		_memMaxBytes = memBytes;
+	}
+
+	void disable_spill()
+	{
+		if (_spill)
+		{
+			while (_spill->size())
+			{
+				_spill->pop(_memQueue);
+			}
+			delete _spill;
+			_spill = NULL;
+			_memSizes.clear();
+			_memBytes = 0;
+		}
+	}
+
+	template <typename... Args>
+	void push_back(Args&&... args)
+	{
+		if (_spill)
+		{
+			if (_spill->size() || (!_memQueue.empty() && _memBytes >= _memMaxBytes))
+			{
+				if (_spill->push(T(std::forward<Args>(args)...)))
+				{
+					return;
+				}
+				//写文件失败，读回已溢出的消息，退回内存模式，保证不丢失且有序
+				disable_spill();
+			}
+			else
+			{
+				_memQueue.push_back(std::forward<Args>(args)...);
+				mem_push_back(_spill->bytes(_memQueue.back()));
+				return;
+			}
+		}
+		_memQueue.push_back(std::forward<Args>(args)...);
+	}
+
+	template <typename... Args>
+	void push_front(Args&&... args)
+	{
+		_memQueue.push_front(std::forward<Args>(args)...);
+		if (_spill)
+		{
+			const size_t bytes = _spill->bytes(_memQueue.front());
+			_memSizes.push_front(bytes);
+			_memBytes += bytes;
+		}
+	}
+
+	T& front()
+	{
+		return _memQueue.front();
+	}
+
+	T& back()
+	{
+		assert(!_spill || !_spill->size());
+		return _memQueue.back();
+	}
+
+	void pop_front()
+	{
+		_memQueue.pop_front();
+		if (_spill)
+		{
+			//消息可能已被移走，按入队时记录的字节数扣减
+			_memBytes -= _memSizes.front();
+			_memSizes.pop_front();
+			if (_memQueue.empty())
+			{
+				//读回约一半预算，留出空间给新消息，避免每次入队都写文件
+				const size_t loadBytes = _memMaxBytes / 2;
+				while (_spill->size() && (_memQueue.empty() || _memBytes < loadBytes))
+				{
+					mem_push_back(_spill->pop(_memQueue));
+				}
+			}
+		}
+	}
+
+	size_t size()
+	{
+		return _memQueue.size() + (_spill ? _spill->size() : 0);
+	}
+
+	bool empty()
+	{
+		return _memQueue.empty();
+	}
+
+	size_t spill_size()
+	{
+		return _spill ? _spill->size() : 0;
+	}
+
+	void clear()
+	{
+		_memQueue.clear();
+		_memSizes.clear();
+		_memBytes = 0;
+		if (_spill)
+		{
+			_spill->clear();
+		}
+	}
+
+	void expand_fixed(size_t fixedSize)
+	{
+		_memQueue.expand_fixed(fixedSize);
+	}
+
+	size_t fixed_size()
+	{
+		return _memQueue.fixed_size();
+	}
+private:
+	void mem_push_back(size_t bytes)
+	{
+		_memSizes.push_back(bytes);
+		_memBytes += bytes;
+	}
+private:
+	msg_queue<T> _memQueue;
+	msg_queue<size_t> _memSizes;
+	MsgSpillFace_<T>* _spill;
+	size_t _memBytes;
+	size_t _memMaxBytes;
+	NONE_COPY(spill_msg_queue);
+};
+
+#endif
@@ -47,6 +47,7 @@ struct shared_initer
 {
 	std::recursive_mutex* _traceMutex = NULL;
 	std::atomic<my_actor::id>* _actorIDCount = NULL;
+	TypeSlotCount_::registry* _typeSlots = NULL;
 };
 static shared_initer s_shared_initer;
 static bool s_isSharedIniter = false;
@@ -54,7 +55,6 @@ static autoActorStackMng* s_autoActorStackMng = NULL;
 mem_alloc_base* shared_bool::_sharedBoolAlloc = NULL;
 std::recursive_mutex* TraceMutex_::_mutex = NULL;
 std::atomic<my_actor::id>* my_actor::_actorIDCount = NULL;
-msg_map_shared_alloc<my_actor::msg_pool_status::id_key, std::shared_ptr<my_actor::msg_pool_status::pck_base> >::shared_node_alloc* my_actor::msg_pool_status::_msgTypeMapAll = NULL;
 
 void my_actor::install()
 {
@@ -73,14 +73,22 @@ void my_actor::install()
 		bind_qt_run_base::install();
 #endif
 #ifdef ENABLE_CHECK_LOST
+#ifdef ENABLE_LITE_CHECK_LOST
+		s_checkLostObjAlloc = new mem_alloc_tls<CHECK_LOST_ALLOC_INDEX, LiteCheckLost_>(MEM_POOL_LENGTH);
+#else
 		s_checkLostObjAlloc = make_shared_space_alloc<CheckLost_, mem_alloc_tls<CHECK_LOST_ALLOC_INDEX, void>>(MEM_POOL_LENGTH, [](CheckLost_*){});
+#endif
 		s_checkPumpLostObjAlloc = make_shared_space_alloc<CheckPumpLost_, mem_alloc_tls<CHECK_PUMP_LOST_ALLOC_INDEX, void>>(MEM_POOL_LENGTH, [](CheckPumpLost_*){});
 #endif
 		s_autoActorStackMng = new autoActorStackMng;
 		shared_bool::_sharedBoolAlloc = make_shared_space_alloc<bool, mem_alloc_tls<SHARED_BOOL_ALLOC_INDEX, void>>(MEM_POOL_LENGTH, [](bool*){});
 		my_actor::_actorIDCount = new std::atomic<my_actor::id>(0);
 		s_shared_initer._actorIDCount = my_actor::_actorIDCount;
-		my_actor::msg_pool_status::_msgTypeMapAll = new msg_map_shared_alloc<my_actor::msg_pool_status::id_key, std::shared_ptr<my_actor::msg_pool_status::pck_base> >::shared_node_alloc(MEM_POOL_LENGTH);
+		if (!TypeSlotCount_::_registry)
+		{
+			TypeSlotCount_::_registry = new TypeSlotCount_::registry;
+		}
+		s_shared_initer._typeSlots = TypeSlotCount_::_registry;
 		generator::install(my_actor::_actorIDCount);
 	}
 }
@@ -102,14 +110,20 @@ void my_actor::install(const shared_initer* initer)
 		bind_qt_run_base::install();
 #endif
 #ifdef ENABLE_CHECK_LOST
+#ifdef ENABLE_LITE_CHECK_LOST
+		s_checkLostObjAlloc = new mem_alloc_tls<CHECK_LOST_ALLOC_INDEX, LiteCheckLost_>(MEM_POOL_LENGTH);
+#else
 		s_checkLostObjAlloc = make_shared_space_alloc<CheckLost_, mem_alloc_tls<CHECK_LOST_ALLOC_INDEX, void>>(MEM_POOL_LENGTH, [](CheckLost_*){});
+#endif
 		s_checkPumpLostObjAlloc = make_shared_space_alloc<CheckPumpLost_, mem_alloc_tls<CHECK_PUMP_LOST_ALLOC_INDEX, void>>(MEM_POOL_LENGTH, [](CheckPumpLost_*){});
 #endif
 		s_autoActorStackMng = new autoActorStackMng;
 		shared_bool::_sharedBoolAlloc = make_shared_space_alloc<bool, mem_alloc_tls<SHARED_BOOL_ALLOC_INDEX, void>>(MEM_POOL_LENGTH, [](bool*){});
 		my_actor::_actorIDCount = initer->_actorIDCount;
 		s_shared_initer._actorIDCount = initer->_actorIDCount;
-		my_actor::msg_pool_status::_msgTypeMapAll = new msg_map_shared_alloc<my_actor::msg_pool_status::id_key, std::shared_ptr<my_actor::msg_pool_status::pck_base> >::shared_node_alloc(MEM_POOL_LENGTH);
+		assert(!TypeSlotCount_::_registry || TypeSlotCount_::_registry == initer->_typeSlots);
+		TypeSlotCount_::_registry = initer->_typeSlots;
+		s_shared_initer._typeSlots = initer->_typeSlots;
 		generator::install(my_actor::_actorIDCount);
 	}
 }
@@ -127,8 +141,7 @@ void my_actor::uninstall()
 			delete my_actor::_actorIDCount;
 		s_shared_initer._actorIDCount = NULL;
 		my_actor::_actorIDCount = NULL;
-		delete my_actor::msg_pool_status::_msgTypeMapAll;
-		my_actor::msg_pool_status::_msgTypeMapAll = NULL;
+		s_shared_initer._typeSlots = NULL;
 		delete s_autoActorStackMng;
 		s_autoActorStackMng = NULL;
 #ifdef ENABLE_CHECK_LOST
@@ -247,6 +260,7 @@ shared_bool shared_bool::new_(bool b)
 
 //////////////////////////////////////////////////////////////////////////
 #ifdef ENABLE_CHECK_LOST
+#ifndef ENABLE_LITE_CHECK_LOST
 CheckLost_::CheckLost_(const shared_strand& strand, msg_handle_base* msgHandle)
 :_strand(strand), _handle(msgHandle), _closed(msgHandle->_closed) {}
 
@@ -264,6 +278,7 @@ CheckLost_::~CheckLost_()
 		}, std::move(_closed)));
 	}
 }
+#endif
 
 //////////////////////////////////////////////////////////////////////////
 CheckPumpLost_::CheckPumpLost_(const actor_handle& hostActor, MsgPoolBase_* pool)
@@ -542,7 +557,7 @@ void MsgPoolVoid_::push_msg(const actor_handle& hostActor)
 {
 	if (_strand->running_in_this_thread())
 	{
-		send_msg(ActorFunc_::shared_from_this(hostActor.get()));
+		send_msg(hostActor);
 	}
 	else
 	{
@@ -596,6 +611,18 @@ void MsgPoolVoid_::send_msg(actor_handle&& hostActor)
 	}
 }
 
+void MsgPoolVoid_::send_msg(const actor_handle& hostActor)
+{
+	if (_waiting)
+	{
+		send_msg(actor_handle(hostActor));
+	}
+	else
+	{
+		_msgBuff.push_back();
+	}
+}
+
 void MsgPoolVoid_::disconnect()
 {
 	assert(_strand->running_in_this_thread());
@@ -1366,10 +1393,10 @@ ActorReadyGo_::ActorReadyGo_(shared_strand strand, size_t stackSize)
 ActorReadyGo_::ActorReadyGo_(io_engine& ios, size_t stackSize)
 : _strand(boost_strand::create(ios)), _stackSize(stackSize) {}
 
-ActorReadyGo_::ActorReadyGo_(shared_strand strand, std::function<void()> notify, size_t stackSize)
+ActorReadyGo_::ActorReadyGo_(shared_strand strand, small_handler<void()> notify, size_t stackSize)
 : _strand(std::move(strand)), _notify(std::move(notify)), _stackSize(stackSize) {}
 
-ActorReadyGo_::ActorReadyGo_(io_engine& ios, std::function<void()> notify, size_t stackSize)
+ActorReadyGo_::ActorReadyGo_(io_engine& ios, small_handler<void()> notify, size_t stackSize)
 : _strand(boost_strand::create(ios)), _notify(std::move(notify)), _stackSize(stackSize) {}
 //////////////////////////////////////////////////////////////////////////
 
@@ -1836,10 +1863,12 @@ my_actor::my_actor()
 	_checkStack = false;
 	_waitingQuit = false;
 	_afterExitCleanStack = false;
+	_quitStatusMode = false;
+	_quitStatus = false;
 #ifdef PRINT_ACTOR_STACK
 	_checkStackFree = false;
 #endif
-	_selfID = ++(*_actorIDCount);
+	_selfID = generator::alloc_id();
 	_actorKey = -1;
 	_lockQuit = 0;
 	_lockSuspend = 0;
@@ -2272,14 +2301,14 @@ void my_actor::usleep(long long us)
 	if (us < 0)
 	{
 		actor_handle lockActor = shared_from_this();
-		push_yield();
+		push_yield_status();
 	}
 	else
 	{
 		_timerStateCompleted = false;
 		_timerStateTime = us;
 		_timerStateHandle = _strand->actor_timer()->timeout(_timerStateTime, shared_from_this());
-		push_yield();
+		push_yield_status();
 	}
 }
 
@@ -2326,7 +2355,7 @@ void my_actor::yield()
 	{
 		shared_this->run_one();
 	}, shared_from_this()));
-	push_yield();
+	push_yield_status();
 }
 
 void my_actor::try_yield()
@@ -2369,7 +2398,7 @@ const std::list<actor_handle>& my_actor::children()
 	return _childActorList;
 }
 
-my_actor::quit_iterator my_actor::regist_quit_executor(std::function<void()> quitHandler)
+my_actor::quit_iterator my_actor::regist_quit_executor(small_handler<void()> quitHandler)
 {
 	assert_enter();
 	_beginQuitExec.push_front(std::move(quitHandler));//后注册的先执行
@@ -2521,7 +2550,7 @@ void my_actor::assert_enter()
 {
 #if (_DEBUG || DEBUG)
 	assert(_strand->running_in_this_thread());
-	assert(!_quited);
+	assert(!_quited || _quitStatus);
 	assert(_inActor);
 	context_yield::context_info* const info = _actorPull->_coroInfo;
 	void* const sp = get_sp();
@@ -2530,9 +2559,9 @@ void my_actor::assert_enter()
 #endif
 }
 
-void my_actor::force_quit(std::function<void()> h)
+void my_actor::force_quit(small_handler<void()> h)
 {
-	_strand->try_tick(std::bind([](actor_handle& shared_this, std::function<void()>& h)
+	_strand->try_tick(std::bind([](actor_handle& shared_this, small_handler<void()>& h)
 	{
 		my_actor* const self = shared_this.get();
 		if (!self->_quited)
@@ -2596,6 +2625,18 @@ void my_actor::force_quit(std::function<void()> h)
 	}, shared_from_this(), std::move(h)));
 }
 
+void my_actor::enable_quit_status(bool enable)
+{
+	assert_enter();
+	_quitStatusMode = enable;
+}
+
+bool my_actor::quit_status()
+{
+	assert(_strand->running_in_this_thread());
+	return _quitStatus;
+}
+
 bool my_actor::is_started()
 {
 	assert(_strand->running_in_this_thread());
@@ -2693,9 +2734,9 @@ void my_actor::after_exit_clean_stack()
 	_afterExitCleanStack = true;
 }
 
-void my_actor::suspend(std::function<void()> h)
+void my_actor::suspend(small_handler<void()> h)
 {
-	_strand->try_tick(std::bind([](actor_handle& shared_this, std::function<void()>& h)
+	_strand->try_tick(std::bind([](actor_handle& shared_this, small_handler<void()>& h)
 	{
 		my_actor* const self = shared_this.get();
 		if (!self->_quited)
@@ -2769,9 +2810,9 @@ void my_actor::child_suspend_then()
 	}
 }
 
-void my_actor::resume(std::function<void()> h)
+void my_actor::resume(small_handler<void()> h)
 {
-	_strand->try_tick(std::bind([](const actor_handle& shared_this, std::function<void()>& h)
+	_strand->try_tick(std::bind([](const actor_handle& shared_this, small_handler<void()>& h)
 	{
 		my_actor* const self = shared_this.get();
 		if (!self->_quited)
@@ -2853,9 +2894,9 @@ void my_actor::child_resume_then()
 	}
 }
 
-void my_actor::switch_pause_play(std::function<void(bool)> h)
+void my_actor::switch_pause_play(small_handler<void(bool)> h)
 {
-	_strand->try_tick(std::bind([](const actor_handle& shared_this, std::function<void(bool)>& h)
+	_strand->try_tick(std::bind([](const actor_handle& shared_this, small_handler<void(bool)>& h)
 	{
 		assert(shared_this->_strand->running_in_this_thread());
 		if (!shared_this->_quited)
@@ -2864,28 +2905,28 @@ void my_actor::switch_pause_play(std::function<void(bool)> h)
 			{
 				if (h)
 				{
-					shared_this->resume(std::bind([](std::function<void(bool)>& h)
+					shared_this->resume(std::bind([](small_handler<void(bool)>& h)
 					{
 						CHECK_EXCEPTION(h, false);
 					}, std::move(h)));
 				}
 				else
 				{
-					shared_this->resume(std::function<void()>());
+					shared_this->resume(small_handler<void()>());
 				}
 			}
 			else
 			{
 				if (h)
 				{
-					shared_this->suspend(std::bind([](std::function<void(bool)>& h)
+					shared_this->suspend(std::bind([](small_handler<void(bool)>& h)
 					{
 						CHECK_EXCEPTION(h, true);
 					}, std::move(h)));
 				}
 				else
 				{
-					shared_this->suspend(std::function<void()>());
+					shared_this->suspend(small_handler<void()>());
 				}
 			}
 		}
@@ -2967,7 +3008,7 @@ void my_actor::outside_wait_quit()
 	conVar.wait(ul);
 }
 
-void my_actor::append_quit_notify(std::function<void()> h)
+void my_actor::append_quit_notify(small_handler<void()> h)
 {
 	if (_strand->running_in_this_thread())
 	{
@@ -2982,7 +3023,7 @@ void my_actor::append_quit_notify(std::function<void()> h)
 	}
 	else
 	{
-		_strand->post(std::bind([](const actor_handle& shared_this, std::function<void()>& h)
+		_strand->post(std::bind([](const actor_handle& shared_this, small_handler<void()>& h)
 		{
 			my_actor* const self = shared_this.get();
 			if (self->_exited)
@@ -2997,7 +3038,7 @@ void my_actor::append_quit_notify(std::function<void()> h)
 	}
 }
 
-void my_actor::append_quit_executor(std::function<void()> h)
+void my_actor::append_quit_executor(small_handler<void()> h)
 {
 	if (_strand->running_in_this_thread())
 	{
@@ -3012,7 +3053,7 @@ void my_actor::append_quit_executor(std::function<void()> h)
 	}
 	else
 	{
-		_strand->post(std::bind([](const actor_handle& shared_this, std::function<void()>& h)
+		_strand->post(std::bind([](const actor_handle& shared_this, small_handler<void()>& h)
 		{
 			my_actor* const self = shared_this.get();
 			if (self->_exited)
@@ -3214,7 +3255,7 @@ void my_actor::pull_yield_after_quited()
 	pull_yield_tls();
 }
 
-void my_actor::push_yield()
+bool my_actor::yield_check_quited()
 {
 	assert(!_exited);
 	assert(_inActor);
@@ -3225,18 +3266,50 @@ void my_actor::push_yield()
 	if (!_quited)
 	{
 		_inActor = true;
+		return false;
 	}
-	else
+	assert(!_lockQuit);
+	assert(!_childOverCount);
+	while (!_beginQuitExec.empty())
+	{
+		CHECK_EXCEPTION(_beginQuitExec.front());
+		_beginQuitExec.pop_front();
+	}
+	return true;
+}
+
+void my_actor::push_yield()
+{
+	if (_quitStatus)
+	{//已经以返回值方式收到退出，不再切出
+		cancel_timer();
+		_inActor = false;
+		throw force_quit_exception();
+	}
+	if (yield_check_quited())
+	{
+		throw force_quit_exception();
+	}
+}
+
+bool my_actor::push_yield_status()
+{
+	if (_quitStatus)
+	{
+		cancel_timer();
+		return true;
+	}
+	if (!yield_check_quited())
+	{
+		return false;
+	}
+	if (!_quitStatusMode)
 	{
-		assert(!_lockQuit);
-		assert(!_childOverCount);
-		while (!_beginQuitExec.empty())
-		{
-			CHECK_EXCEPTION(_beginQuitExec.front());
-			_beginQuitExec.pop_front();
-		}
 		throw force_quit_exception();
 	}
+	_quitStatus = true;
+	_inActor = true;
+	return true;
 }
 
 void my_actor::push_yield_after_quited()
@@ -3392,8 +3465,7 @@ bool my_actor::_timed_wait_msg(int ms, const wrap_local_handler_face<void()>& th
 				overtime = true;
 				th();
 			});
-			push_yield();
-			if (overtime)
+			if (push_yield_status() || overtime)
 			{
 				return false;
 			}
@@ -3434,8 +3506,7 @@ bool my_actor::_timed_wait_trig_sign(int ms, int id, const wrap_local_handler_fa
 				overtime = true;
 				th();
 			});
-			push_yield();
-			if (overtime)
+			if (push_yield_status() || overtime)
 			{
 				return false;
 			}
@@ -3480,8 +3551,7 @@ bool my_actor::_timed_pump_msg(int ms, const wrap_local_handler_face<void()>& th
 				overtime = true;
 				th();
 			});
-			push_yield();
-			if (overtime)
+			if (push_yield_status() || overtime)
 			{
 				return false;
 			}
@@ -3686,6 +3756,42 @@ void ActorFunc_::cancel_timer(my_actor* host)
 }
 
 #ifdef ENABLE_CHECK_LOST
+#ifdef ENABLE_LITE_CHECK_LOST
+LiteCheckLost_* ActorFunc_::new_lite_check_lost()
+{
+	LiteCheckLost_* checkLost = new(s_checkLostObjAlloc->allocate())LiteCheckLost_;
+	checkLost->_refCount = 1;
+	return checkLost;
+}
+
+LiteCheckLost_* ActorFunc_::ref_lite_check_lost(LiteCheckLost_* checkLost)
+{
+	if (checkLost)
+	{
+		checkLost->_refCount.fetch_add(1, std::memory_order_relaxed);
+	}
+	return checkLost;
+}
+
+void ActorFunc_::release_lite_check_lost(LiteCheckLost_* checkLost, const actor_handle& hostActor, msg_handle_base* msgHandle, const shared_bool& closed)
+{
+	if (1 == checkLost->_refCount.fetch_sub(1, std::memory_order_acq_rel))
+	{
+		checkLost->~LiteCheckLost_();
+		s_checkLostObjAlloc->deallocate(checkLost);
+		if (!closed)
+		{
+			self_strand(hostActor.get())->try_tick(std::bind([msgHandle](const shared_bool& closed)
+			{
+				if (!closed)
+				{
+					msgHandle->lost_msg();
+				}
+			}, closed));
+		}
+	}
+}
+#else
 std::shared_ptr<CheckLost_> ActorFunc_::new_check_lost(const shared_strand& strand, msg_handle_base* msgHandle)
 {
 	void* space = s_checkLostObjAlloc->allocate();
@@ -3694,6 +3800,7 @@ std::shared_ptr<CheckLost_> ActorFunc_::new_check_lost(const shared_strand& stra
 		p->~CheckLost_();
 	}, ref_count_alloc2<CheckLost_>(space, s_checkLostObjAlloc));
 }
+#endif
 
 std::shared_ptr<CheckPumpLost_> ActorFunc_::new_check_pump_lost(const actor_handle& hostActor, MsgPoolBase_* pool)
 {
@@ -2,6 +2,8 @@
 #define __MY_ACTOR_H
 
 #include <list>
+#include <vector>
+#include <deque>
 #include <functional>
 #include "io_engine.h"
 #include "run_strand.h"
@@ -28,6 +30,12 @@ typedef ContextPool_::coro_pull_interface actor_pull_type;
 //此函数会上下文切换
 #define __yield_interrupt
 
+//轻量丢失检测，只作用于MsgNotiferBase_(msg_notifer/trig_notifer的共同基类)，副本共享一个侵入式计数，替代shared_ptr<CheckLost_>
+//post_actor_msg仍使用CheckPumpLost_，trig_once_notifer不做丢失检测
+#if (defined ENABLE_LITE_CHECK_LOST) && !(defined ENABLE_CHECK_LOST)
+#define ENABLE_CHECK_LOST
+#endif
+
 #if (_DEBUG || DEBUG)
 
 // 用于检测在Actor内调用的函数是否触发了强制退出
@@ -63,6 +71,7 @@ template <typename... ARGS>
 class msg_pump_handle;
 class CheckLost_;
 class CheckPumpLost_;
+struct LiteCheckLost_;
 class msg_handle_base;
 class MsgPoolBase_;
 
@@ -93,7 +102,13 @@ struct ActorFunc_
 	template <typename DST, typename SRC>
 	static void _trig_handler2(my_actor* host, shared_bool& closed, bool* sign, DST& dstRec, SRC&& args);
 #ifdef ENABLE_CHECK_LOST
+#ifdef ENABLE_LITE_CHECK_LOST
+	static LiteCheckLost_* new_lite_check_lost();
+	static LiteCheckLost_* ref_lite_check_lost(LiteCheckLost_* checkLost);
+	static void release_lite_check_lost(LiteCheckLost_* checkLost, const actor_handle& hostActor, msg_handle_base* msgHandle, const shared_bool& closed);
+#else
 	static std::shared_ptr<CheckLost_> new_check_lost(const shared_strand& strand, msg_handle_base* msgHandle);
+#endif
 	static std::shared_ptr<CheckPumpLost_> new_check_pump_lost(const actor_handle& hostActor, MsgPoolBase_* pool);
 	static std::shared_ptr<CheckPumpLost_> new_check_pump_lost(actor_handle&& hostActor, MsgPoolBase_* pool);
 #endif
@@ -111,6 +126,16 @@ struct ntf_lost_exception {};
 struct pump_disconnected_exception { };
 
 #ifdef ENABLE_CHECK_LOST
+#ifdef ENABLE_LITE_CHECK_LOST
+/*!
+@brief 一次make_notifer产生的所有通知函数副本共享的引用计数，
+最后一个副本释放时，如果句柄还未关闭则通知消息丢失
+*/
+struct LiteCheckLost_
+{
+	std::atomic<size_t> _refCount;
+};
+#else
 class CheckLost_
 {
 	friend ActorFunc_;
@@ -123,6 +148,7 @@ private:
 	shared_bool _closed;
 	msg_handle_base* _handle;
 };
+#endif
 
 class CheckPumpLost_
 {
@@ -149,6 +175,19 @@ struct DstReceiverBase_
 	virtual void move_from(std::tuple<ArgsPipe...>&& s) = 0;
 	virtual void clear() = 0;
 	virtual bool has() = 0;
+
+	/*!
+	@brief 是否以引用方式接收消息(消息留在句柄队列中)
+	*/
+	virtual bool lendable()
+	{
+		return false;
+	}
+
+	virtual void lend(std::tuple<ArgsPipe...>& s)
+	{
+		assert(false);
+	}
 };
 
 template <typename... ARGS>
@@ -172,6 +211,43 @@ struct DstReceiverBuff_ : public DstReceiverBase_<TYPE_PIPE(ARGS)...>
 	stack_obj<std::tuple<TYPE_PIPE(ARGS)...>> _dstBuff;
 };
 
+/*!
+@brief 以引用方式接收消息，引用在下次从同一句柄提取消息前有效
+*/
+template <typename... ARGS>
+struct DstReceiverLend_ : public DstReceiverBase_<TYPE_PIPE(ARGS)...>
+{
+	DstReceiverLend_()
+		:_msg(NULL) {}
+
+	void move_from(std::tuple<TYPE_PIPE(ARGS)...>&& s)
+	{
+		assert(false);
+	}
+
+	void clear()
+	{
+		_msg = NULL;
+	}
+
+	bool has()
+	{
+		return !!_msg;
+	}
+
+	bool lendable()
+	{
+		return true;
+	}
+
+	void lend(std::tuple<TYPE_PIPE(ARGS)...>& s)
+	{
+		_msg = &s;
+	}
+
+	std::tuple<TYPE_PIPE(ARGS)...>* _msg;
+};
+
 template <typename... ARGS, typename... OUTS>
 struct DstReceiverRef_<types_pck<ARGS...>, types_pck<OUTS...>> : public DstReceiverBase_<TYPE_PIPE(ARGS)...>
 {
@@ -247,6 +323,7 @@ class select_block_pump_check_lost;
 class msg_handle_base
 {
 	friend CheckLost_;
+	friend ActorFunc_;
 protected:
 	msg_handle_base();
 	virtual ~msg_handle_base(){}
@@ -298,23 +375,39 @@ class MsgNotiferBase_
 	typedef ActorMsgHandlePush_<ARGS...> MsgHandle;
 protected:
 	MsgNotiferBase_()
-		:_msgHandle(NULL){}
+		:_msgHandle(NULL)
+#ifdef ENABLE_LITE_CHECK_LOST
+		, _liteCheckLost(NULL)
+#endif
+	{}
 
 	MsgNotiferBase_(MsgHandle* msgHandle, bool checkLost)
 		:_msgHandle(msgHandle),
 		_hostActor(ActorFunc_::shared_from_this(_msgHandle->_hostActor)),
-		_closed(msgHandle->_closed)		
+		_closed(msgHandle->_closed)
+#ifdef ENABLE_LITE_CHECK_LOST
+		, _liteCheckLost(checkLost ? ActorFunc_::new_lite_check_lost() : NULL)
+#endif
 	{
 		assert(msgHandle->_strand == ActorFunc_::self_strand(_hostActor.get()));
 #ifdef ENABLE_CHECK_LOST
+#ifndef ENABLE_LITE_CHECK_LOST
 		if (checkLost)
 		{
 			_autoCheckLost = ActorFunc_::new_check_lost(ActorFunc_::self_strand(_hostActor.get()), msgHandle);
 		}
+#endif
 #else
 		assert(!checkLost);
 #endif
 	}
+
+#ifdef ENABLE_LITE_CHECK_LOST
+	~MsgNotiferBase_()
+	{
+		release_check_lost();
+	}
+#endif
 public:
 	template <typename... Args>
 	void operator()(Args&&... args) const
@@ -381,12 +474,14 @@ public:
 
 	void clear()
 	{
+#ifdef ENABLE_LITE_CHECK_LOST
+		release_check_lost();
+#elif (defined ENABLE_CHECK_LOST)
+		_autoCheckLost.reset();
+#endif
 		_msgHandle = NULL;
 		_hostActor.reset();
 		_closed.reset();
-#ifdef ENABLE_CHECK_LOST
-		_autoCheckLost.reset();
-#endif
 	}
 
 	operator bool() const
@@ -401,45 +496,78 @@ public:
 protected:
 	MsgNotiferBase_(const MsgNotiferBase_<ARGS...>& s)
 		:_msgHandle(s._msgHandle), _hostActor(s._hostActor), _closed(s._closed)
-#ifdef ENABLE_CHECK_LOST
+#ifdef ENABLE_LITE_CHECK_LOST
+		, _liteCheckLost(ActorFunc_::ref_lite_check_lost(s._liteCheckLost))
+#elif (defined ENABLE_CHECK_LOST)
 		, _autoCheckLost(s._autoCheckLost)
 #endif
 	{}
 
 	MsgNotiferBase_(MsgNotiferBase_<ARGS...>&& s)
 		:_msgHandle(s._msgHandle), _hostActor(std::move(s._hostActor)), _closed(std::move(s._closed))
-#ifdef ENABLE_CHECK_LOST
+#ifdef ENABLE_LITE_CHECK_LOST
+		, _liteCheckLost(s._liteCheckLost)
+#elif (defined ENABLE_CHECK_LOST)
 		, _autoCheckLost(std::move(s._autoCheckLost))
 #endif
 	{
 		s._msgHandle = NULL;
+#ifdef ENABLE_LITE_CHECK_LOST
+		s._liteCheckLost = NULL;
+#endif
 	}
 
 	void operator =(const MsgNotiferBase_<ARGS...>& s)
 	{
+#ifdef ENABLE_LITE_CHECK_LOST
+		LiteCheckLost_* checkLost = ActorFunc_::ref_lite_check_lost(s._liteCheckLost);
+		release_check_lost();
+		_liteCheckLost = checkLost;
+#endif
 		_msgHandle = s._msgHandle;
 		_hostActor = s._hostActor;
 		_closed = s._closed;
-#ifdef ENABLE_CHECK_LOST
+#if (defined ENABLE_CHECK_LOST) && !(defined ENABLE_LITE_CHECK_LOST)
 		_autoCheckLost = s._autoCheckLost;
 #endif
 	}
 
 	void operator =(MsgNotiferBase_<ARGS...>&& s)
 	{
+#ifdef ENABLE_LITE_CHECK_LOST
+		if (this != &s)
+		{
+			release_check_lost();
+			_liteCheckLost = s._liteCheckLost;
+			s._liteCheckLost = NULL;
+		}
+#endif
 		_msgHandle = s._msgHandle;
 		_hostActor = std::move(s._hostActor);
 		_closed = std::move(s._closed);
-#ifdef ENABLE_CHECK_LOST
+#if (defined ENABLE_CHECK_LOST) && !(defined ENABLE_LITE_CHECK_LOST)
 		_autoCheckLost = std::move(s._autoCheckLost);
 #endif
 		s._msgHandle = NULL;
 	}
+#ifdef ENABLE_LITE_CHECK_LOST
 private:
+	void release_check_lost()
+	{
+		if (_liteCheckLost)
+		{
+			ActorFunc_::release_lite_check_lost(_liteCheckLost, _hostActor, _msgHandle, _closed);
+			_liteCheckLost = NULL;
+		}
+	}
+#endif
+protected:
 	MsgHandle* _msgHandle;
 	actor_handle _hostActor;
 	shared_bool _closed;
-#ifdef ENABLE_CHECK_LOST
+#ifdef ENABLE_LITE_CHECK_LOST
+	LiteCheckLost_* _liteCheckLost;
+#elif (defined ENABLE_CHECK_LOST)
 	std::shared_ptr<CheckLost_> _autoCheckLost;
 #endif
 };
@@ -469,6 +597,34 @@ public:
 	{
 		MsgNotiferBase_<ARGS...>::operator =(std::move(s));
 	}
+public:
+	/*!
+	@brief 用参数在接收方消息队列节点中直接构造消息，接收方可用 wait_msg_ref 直接引用该节点
+	*/
+	template <typename... Args>
+	void emplace(Args&&... args) const
+	{
+		static_assert(sizeof...(ARGS) == sizeof...(Args), "");
+		assert(!this->empty());
+		if (!this->_closed)
+		{
+			msg_handle<ARGS...>* const msgHandle = static_cast<msg_handle<ARGS...>*>(this->_msgHandle);
+			if (ActorFunc_::self_strand(this->_hostActor.get())->running_in_this_thread())
+			{
+				msgHandle->emplace_msg(std::forward<Args>(args)...);
+			}
+			else
+			{
+				ActorFunc_::self_strand(this->_hostActor.get())->post(std::bind([](actor_handle& hostActor, msg_handle<ARGS...>* msgHandle, shared_bool& closed, RM_CREF(Args)&... args)
+				{
+					if (!closed)
+					{
+						msgHandle->emplace_msg(std::move(args)...);
+					}
+				}, this->_hostActor, msgHandle, this->_closed, std::forward<Args>(args)...));
+			}
+		}
+	}
 };
 
 template <typename... ARGS>
@@ -511,11 +667,12 @@ class msg_handle : public ActorMsgHandlePush_<ARGS...>
 	friend select_block_msg_check_lost<ARGS...>;
 #endif
 	friend my_actor;
+	friend MsgNotifer;
 public:
 	struct lost_exception : ntf_lost_exception {};
 public:
 	msg_handle(size_t fixedSize = 16)
-		:_msgBuff(fixedSize), _dstRec(NULL) {}
+		:_msgBuff(fixedSize), _dstRec(NULL), _lent(false) {}
 
 	~msg_handle()
 	{
@@ -540,7 +697,16 @@ private:
 				Parent::_waiting = false;
 				assert(_msgBuff.empty());
 				assert(_dstRec);
-				_dstRec->move_from(std::move(msg));
+				if (_dstRec->lendable())
+				{
+					_msgBuff.push_back(std::move(msg));
+					_dstRec->lend(_msgBuff.front());
+					_lent = true;
+				}
+				else
+				{
+					_dstRec->move_from(std::move(msg));
+				}
 				_dstRec = NULL;
 				ActorFunc_::pull_yield(Parent::_hostActor);
 				return;
@@ -550,15 +716,66 @@ private:
 		}
 	}
 
+	template <typename... Args>
+	void emplace_msg(Args&&... args)
+	{
+		assert(Parent::_strand->running_in_this_thread());
+		if (!ActorFunc_::is_quited(Parent::_hostActor))
+		{
+			if (Parent::_waiting)
+			{
+				Parent::_waiting = false;
+				assert(_msgBuff.empty());
+				assert(_dstRec);
+				if (_dstRec->lendable())
+				{
+					_msgBuff.push_back(std::forward<Args>(args)...);
+					_dstRec->lend(_msgBuff.front());
+					_lent = true;
+				}
+				else
+				{
+					_dstRec->move_from(msg_type(std::forward<Args>(args)...));
+				}
+				_dstRec = NULL;
+				ActorFunc_::pull_yield(Parent::_hostActor);
+				return;
+			}
+			assert(_msgBuff.size() < _msgBuff.fixed_size());
+			_msgBuff.push_back(std::forward<Args>(args)...);
+		}
+	}
+
+	/*!
+	@brief 释放上次以引用方式借出的队首消息
+	*/
+	void release_lent()
+	{
+		if (_lent)
+		{
+			_lent = false;
+			_msgBuff.pop_front();
+		}
+	}
+
 	bool read_msg(dst_receiver& dst)
 	{
 		assert(Parent::_strand->running_in_this_thread());
 		assert(!Parent::_closed.empty());
 		assert(!Parent::_closed);
+		release_lent();
 		if (!_msgBuff.empty())
 		{
-			dst.move_from(std::move(_msgBuff.front()));
-			_msgBuff.pop_front();
+			if (dst.lendable())
+			{
+				dst.lend(_msgBuff.front());
+				_lent = true;
+			}
+			else
+			{
+				dst.move_from(std::move(_msgBuff.front()));
+				_msgBuff.pop_front();
+			}
 			return true;
 		}
 		_dstRec = &dst;
@@ -589,6 +806,7 @@ public:
 		Parent::_waiting = false;
 		Parent::_losted = false;
 		Parent::_checkLost = false;
+		_lent = false;
 		_msgBuff.clear();
 		Parent::_hostActor = NULL;
 	}
@@ -596,11 +814,12 @@ public:
 	size_t size()
 	{
 		assert(Parent::_strand->running_in_this_thread());
-		return _msgBuff.size();
+		return _msgBuff.size() - (_lent ? 1 : 0);
 	}
 private:
 	dst_receiver* _dstRec;
 	msg_queue<msg_type> _msgBuff;
+	bool _lent;
 };
 
 template <>
@@ -960,6 +1179,527 @@ private:
 	bool* _dstRec;
 	bool _hasMsg;
 };
+
+template <typename... R>
+class ask_box;
+
+template <typename... R>
+class ask_reply;
+
+/*!
+@brief 请求句柄，指向ask_box中的一个应答槽位
+*/
+template <typename... R>
+struct ask_future
+{
+	ask_future()
+		:_idx(0), _gen(0) {}
+
+	ask_future(unsigned idx, unsigned gen)
+		:_idx(idx), _gen(gen) {}
+
+	bool empty() const
+	{
+		return !_gen;
+	}
+
+	unsigned _idx;
+	unsigned _gen;
+};
+
+/*!
+@brief ask_box内部状态，应答槽位复用，所有请求的超时共用一个按截止时间排序的最小堆，
+已完成未取出的请求串成链表供ask_wait_any按完成顺序取出；槽位取出或丢弃时同时移出堆和链表，
+只在Actor strand中访问
+*/
+template <typename... R>
+class AskCore_
+{
+	typedef std::tuple<TYPE_PIPE(R)...> msg_type;
+	typedef ask_future<R...> future_type;
+
+	friend my_actor;
+	friend ask_box<R...>;
+	friend ask_reply<R...>;
+
+	enum { ask_free, ask_pending, ask_replied, ask_timeout };
+	enum { wait_any = -1, wait_all = -2 };
+	static const unsigned npos = (unsigned)-1;
+
+	struct slot
+	{
+		slot()
+			:_gen(1), _heapPos(npos), _donePrev(npos), _doneNext(npos), _inDone(false), _state(ask_free) {}
+
+		~slot()
+		{
+			reset();
+		}
+
+		void reset()
+		{
+			if (ask_replied == _state)
+			{
+				as_ptype<msg_type>(_res)->~msg_type();
+			}
+			_state = ask_free;
+		}
+
+		__space_align char _res[sizeof(msg_type)];
+		unsigned _gen;
+		unsigned _heapPos;
+		unsigned _donePrev;
+		unsigned _doneNext;
+		bool _inDone;
+		unsigned char _state;
+	};
+
+	struct deadline_node
+	{
+		long long _us;
+		unsigned _idx;
+	};
+public:
+	AskCore_()
+		:_host(NULL), _pending(0), _doneHead(npos), _doneTail(npos), _waitIdx(wait_any), _waiting(false), _closed(false) {}
+private:
+	void bind(my_actor* host)
+	{
+		assert(!_host || _host == host);
+		if (!_host)
+		{
+			_host = host;
+			_strand = ActorFunc_::self_strand(host);
+		}
+	}
+
+	future_type new_ask(long long deadlineUs)
+	{
+		unsigned idx;
+		if (!_freeSlots.empty())
+		{
+			idx = _freeSlots.back();
+			_freeSlots.pop_back();
+		}
+		else
+		{
+			idx = (unsigned)_slots.size();
+			_slots.emplace_back();
+		}
+		slot& s = _slots[idx];
+		assert(ask_free == s._state);
+		s._state = ask_pending;
+		_pending++;
+		if (deadlineUs >= 0)
+		{
+			heap_push(idx, deadlineUs);
+		}
+		return future_type(idx, s._gen);
+	}
+
+	void complete(unsigned idx, unsigned gen, msg_type&& res)
+	{
+		assert(_strand->running_in_this_thread());
+		if (_closed || idx >= _slots.size())
+		{
+			return;
+		}
+		slot& s = _slots[idx];
+		if (s._gen != gen || ask_pending != s._state)
+		{
+			return;
+		}
+		new(s._res)msg_type(std::move(res));
+		s._state = ask_replied;
+		finish(idx);
+		if (_waiting && ((int)idx == _waitIdx || wait_any == _waitIdx || (wait_all == _waitIdx && !_pending)))
+		{
+			_waiting = false;
+			ActorFunc_::pull_yield(_host);
+		}
+	}
+
+	/*!
+	@brief 请求完成(应答或超时)，移出截止时间堆，追加到完成链表
+	*/
+	void finish(unsigned idx)
+	{
+		_pending--;
+		slot& s = _slots[idx];
+		if (npos != s._heapPos)
+		{
+			heap_remove(s._heapPos);
+		}
+		s._inDone = true;
+		s._donePrev = _doneTail;
+		s._doneNext = npos;
+		if (npos != _doneTail)
+		{
+			_slots[_doneTail]._doneNext = idx;
+		}
+		else
+		{
+			_doneHead = idx;
+		}
+		_doneTail = idx;
+	}
+
+	void unlink_done(unsigned idx)
+	{
+		slot& s = _slots[idx];
+		assert(s._inDone);
+		if (npos != s._donePrev)
+		{
+			_slots[s._donePrev]._doneNext = s._doneNext;
+		}
+		else
+		{
+			_doneHead = s._doneNext;
+		}
+		if (npos != s._doneNext)
+		{
+			_slots[s._doneNext]._donePrev = s._donePrev;
+		}
+		else
+		{
+			_doneTail = s._donePrev;
+		}
+		s._donePrev = npos;
+		s._doneNext = npos;
+		s._inDone = false;
+	}
+
+	/*!
+	@brief 截止时间已到的请求标记为超时
+	*/
+	void expire(long long nowUs)
+	{
+		while (!_deadlines.empty() && _deadlines.front()._us <= nowUs)
+		{
+			const unsigned idx = _deadlines.front()._idx;
+			assert(ask_pending == _slots[idx]._state);
+			_slots[idx]._state = ask_timeout;
+			finish(idx);
+		}
+	}
+
+	/*!
+	@brief 最早的截止时间，没有返回-1
+	*/
+	long long next_deadline()
+	{
+		return _deadlines.empty() ? -1 : _deadlines.front()._us;
+	}
+
+	/*!
+	@brief 句柄是否仍指向未取出的请求，取出或丢弃后槽位代数已变，旧句柄失效
+	*/
+	bool is_live(const future_type& f)
+	{
+		if (f.empty() || f._idx >= _slots.size())
+		{
+			return false;
+		}
+		slot& s = _slots[f._idx];
+		return s._gen == f._gen && ask_free != s._state;
+	}
+
+	bool is_done(const future_type& f)
+	{
+		return !is_live(f) || ask_pending != _slots[f._idx]._state;
+	}
+
+	bool has_done()
+	{
+		return npos != _doneHead;
+	}
+
+	/*!
+	@brief 取出最早完成的请求句柄
+	*/
+	future_type pop_done()
+	{
+		assert(has_done());
+		const unsigned idx = _doneHead;
+		unlink_done(idx);
+		return future_type(idx, _slots[idx]._gen);
+	}
+
+	bool satisfied(int target, const future_type& f)
+	{
+		if (wait_any == target)
+		{
+			return has_done();
+		}
+		else if (wait_all == target)
+		{
+			return !_pending;
+		}
+		return is_done(f);
+	}
+
+	template <typename... Outs>
+	bool take(const future_type& f, Outs&... res)
+	{
+		if (!is_live(f) || ask_pending == _slots[f._idx]._state)
+		{//句柄已失效(槽位可能已被新请求复用)或请求未完成，不动槽位
+			return false;
+		}
+		slot& s = _slots[f._idx];
+		const bool ok = ask_replied == s._state;
+		if (ok)
+		{
+			std::tie(res...) = std::move(*as_ptype<msg_type>(s._res));
+		}
+		release(f._idx);
+		return ok;
+	}
+
+	void discard(const future_type& f)
+	{
+		if (is_live(f))
+		{
+			slot& s = _slots[f._idx];
+			if (ask_pending == s._state)
+			{
+				_pending--;
+			}
+			release(f._idx);
+		}
+	}
+
+	void release(unsigned idx)
+	{
+		slot& s = _slots[idx];
+		if (npos != s._heapPos)
+		{
+			heap_remove(s._heapPos);
+		}
+		if (s._inDone)
+		{
+			unlink_done(idx);
+		}
+		s.reset();
+		if (!++s._gen)
+		{
+			s._gen = 1;
+		}
+		_freeSlots.push_back(idx);
+	}
+
+	void heap_push(unsigned idx, long long us)
+	{
+		deadline_node node = { us, idx };
+		_deadlines.push_back(node);
+		heap_up((unsigned)_deadlines.size() - 1);
+	}
+
+	void heap_remove(unsigned pos)
+	{
+		assert(pos < _deadlines.size());
+		_slots[_deadlines[pos]._idx]._heapPos = npos;
+		const unsigned last = (unsigned)_deadlines.size() - 1;
+		if (pos != last)
+		{
+			_deadlines[pos] = _deadlines[last];
+			_deadlines.pop_back();
+			heap_set(pos);
+			heap_down(heap_up(pos));
+		}
+		else
+		{
+			_deadlines.pop_back();
+		}
+	}
+
+	unsigned heap_up(unsigned pos)
+	{
+		while (pos)
+		{
+			const unsigned parent = (pos - 1) / 2;
+			if (_deadlines[parent]._us <= _deadlines[pos]._us)
+			{
+				break;
+			}
+			std::swap(_deadlines[parent], _deadlines[pos]);
+			heap_set(pos);
+			pos = parent;
+		}
+		heap_set(pos);
+		return pos;
+	}
+
+	void heap_down(unsigned pos)
+	{
+		const unsigned size = (unsigned)_deadlines.size();
+		while (true)
+		{
+			unsigned child = 2 * pos + 1;
+			if (child >= size)
+			{
+				break;
+			}
+			if (child + 1 < size && _deadlines[child + 1]._us < _deadlines[child]._us)
+			{
+				child++;
+			}
+			if (_deadlines[pos]._us <= _deadlines[child]._us)
+			{
+				break;
+			}
+			std::swap(_deadlines[pos], _deadlines[child]);
+			heap_set(pos);
+			pos = child;
+		}
+		heap_set(pos);
+	}
+
+	void heap_set(unsigned pos)
+	{
+		_slots[_deadlines[pos]._idx]._heapPos = pos;
+	}
+
+	void close()
+	{
+		_closed = true;
+		_waiting = false;
+		_slots.clear();
+		_freeSlots.clear();
+		_deadlines.clear();
+		_doneHead = npos;
+		_doneTail = npos;
+		_pending = 0;
+	}
+private:
+	my_actor* _host;
+	shared_strand _strand;
+	std::deque<slot> _slots;
+	std::vector<unsigned> _freeSlots;
+	std::vector<deadline_node> _deadlines;
+	size_t _pending;
+	unsigned _doneHead;
+	unsigned _doneTail;
+	int _waitIdx;
+	bool _waiting;
+	bool _closed;
+	NONE_COPY(AskCore_);
+};
+
+/*!
+@brief 请求应答盒，一个Actor通过它同时挂起大量请求(my_actor::ask)，
+可单独等待(ask_wait)、等待任一(ask_wait_any)或等待全部(ask_wait_all)完成；
+槽位复用，超时共用一个截止时间堆与Actor内部定时器，不为每个请求分配句柄和定时器
+*/
+template <typename... R>
+class ask_box
+{
+	typedef AskCore_<R...> core_type;
+	typedef ask_future<R...> future_type;
+	friend my_actor;
+public:
+	ask_box()
+		:_core(new core_type) {}
+
+	~ask_box()
+	{
+		assert(!_core->_strand || _core->_strand->running_in_this_thread());
+		_core->close();
+	}
+
+	/*!
+	@brief 取出已完成请求的应答并释放槽位，应答到达返回true，超时返回false；
+	句柄已取出、已丢弃或请求未完成时返回false，不影响其它请求
+	*/
+	template <typename... Outs>
+	bool take(const future_type& f, Outs&... res)
+	{
+		assert(!_core->_strand || _core->_strand->running_in_this_thread());
+		return _core->take(f, res...);
+	}
+
+	/*!
+	@brief 放弃一个请求，之后到达的应答被丢弃
+	*/
+	void discard(const future_type& f)
+	{
+		assert(!_core->_strand || _core->_strand->running_in_this_thread());
+		_core->discard(f);
+	}
+
+	/*!
+	@brief 请求是否已完成(应答或超时)
+	*/
+	bool is_done(const future_type& f) const
+	{
+		assert(!_core->_strand || _core->_strand->running_in_this_thread());
+		return _core->is_done(f);
+	}
+
+	/*!
+	@brief 未完成的请求数
+	*/
+	size_t pending() const
+	{
+		return _core->_pending;
+	}
+private:
+	std::shared_ptr<core_type> _core;
+	NONE_COPY(ask_box);
+};
+
+/*!
+@brief 应答函数，交给服务方调用一次，可跨strand
+*/
+template <typename... R>
+class ask_reply
+{
+	typedef AskCore_<R...> core_type;
+	typedef std::tuple<TYPE_PIPE(R)...> msg_type;
+	friend my_actor;
+public:
+	ask_reply()
+		:_idx(0), _gen(0) {}
+private:
+	ask_reply(const std::shared_ptr<core_type>& core, const ask_future<R...>& f)
+		:_core(core), _idx(f._idx), _gen(f._gen) {}
+public:
+	template <typename... Args>
+	void operator()(Args&&... args) const
+	{
+		static_assert(sizeof...(R) == sizeof...(Args), "");
+		assert(!empty());
+		if (_core->_strand->running_in_this_thread())
+		{
+			_core->complete(_idx, _gen, msg_type(std::forward<Args>(args)...));
+		}
+		else
+		{
+			_core->_strand->post(std::bind([](const std::shared_ptr<core_type>& core, unsigned idx, unsigned gen, msg_type& res)
+			{
+				core->complete(idx, gen, std::move(res));
+			}, _core, _idx, _gen, msg_type(std::forward<Args>(args)...)));
+		}
+	}
+
+	bool empty() const
+	{
+		return !_core;
+	}
+
+	void clear()
+	{
+		_core.reset();
+	}
+
+	operator bool() const
+	{
+		return !empty();
+	}
+private:
+	std::shared_ptr<core_type> _core;
+	unsigned _idx;
+	unsigned _gen;
+};
 //////////////////////////////////////////////////////////////////////////
 
 template <typename... ARGS>
@@ -971,6 +1711,23 @@ class MsgPool_;
 template <typename... ARGS>
 class post_actor_msg;
 
+template <typename... ARGS>
+class multicast_actor_msg;
+
+/*!
+@brief 默认三通道时的消息优先级通道编号，见 my_actor::msg_pump_lanes
+*/
+struct msg_lane
+{
+	enum
+	{
+		high = 0,
+		normal = 1,
+		low = 2,
+		count = 3
+	};
+};
+
 class MsgPumpBase_
 {
 	friend my_actor;
@@ -1025,6 +1782,9 @@ private:
 		res->_waitConnect = false;
 		res->_checkLost = checkLost;
 		res->_pumpCount = 0;
+		res->_laneNum = 1;
+		res->_defaultLane = 0;
+		res->_starveLimit = 0;
 		res->_dstRec = NULL;
 		res->_hostActor = hostActor;
 		res->_strand = ActorFunc_::self_strand(hostActor);
@@ -1286,6 +2046,9 @@ private:
 	shared_strand _strand;
 	dst_receiver* _dstRec;
 	DEBUG_OPERATION(shared_bool _closed);
+	size_t _laneNum;
+	size_t _defaultLane;
+	size_t _starveLimit;
 	unsigned char _pumpCount;
 	bool _hasMsg : 1;
 	bool _waiting : 1;
@@ -1315,6 +2078,8 @@ class MsgPool_ : public MsgPoolBase_
 	typedef MsgPump_<ARGS...> msg_pump_type;
 	typedef post_actor_msg<ARGS...> post_type;
 
+	struct emplace_tag {};
+
 	struct msg_pck 
 	{
 		msg_pck()
@@ -1332,6 +2097,13 @@ class MsgPool_ : public MsgPoolBase_
 			_isMsg = true;
 		}
 
+		template <typename... Args>
+		msg_pck(emplace_tag, Args&&... args)
+		{
+			new(_msg)msg_type(std::forward<Args>(args)...);
+			_isMsg = true;
+		}
+
 		msg_pck(const msg_pck& s)
 		{
 			if (s._isMsg)
@@ -1576,6 +2348,7 @@ class MsgPool_ : public MsgPoolBase_
 	friend my_actor;
 	friend msg_pump_type;
 	friend post_type;
+	friend multicast_actor_msg<ARGS...>;
 	FRIEND_SHARED_PTR(MsgPool_<ARGS...>);
 private:
 	MsgPool_(size_t fixedSize)
@@ -1600,7 +2373,11 @@ private:
 		return res;
 	}
 
-	void send_msg(msg_type&& mt, actor_handle&& hostActor)
+	/*!
+	@brief hostActor为左值时只在唤醒Actor时才复制句柄，消息进缓冲时不产生引用计数操作
+	*/
+	template <typename Handle>
+	void send_msg(msg_type&& mt, Handle&& hostActor)
 	{
 		if (_closed) return;
 
@@ -1610,7 +2387,7 @@ private:
 			assert(_msgPump);
 			assert(_msgBuff.empty());
 			_sendCount++;
-			_msgPump->receive_msg(std::move(mt), std::move(hostActor));
+			_msgPump->receive_msg(std::move(mt), actor_handle(std::forward<Handle>(hostActor)));
 		}
 		else
 		{
@@ -1625,7 +2402,7 @@ private:
 
 		if (_strand->running_in_this_thread())
 		{
-			send_msg(std::move(mt), ActorFunc_::shared_from_this(hostActor.get()));
+			send_msg(std::move(mt), hostActor);
 		}
 		else
 		{
@@ -1636,6 +2413,73 @@ private:
 		}
 	}
 
+	template <typename Handle>
+	void send_lane_msg(size_t lane, msg_type&& mt, Handle&& hostActor)
+	{
+		if (_closed) return;
+
+		if (_waiting)
+		{
+			send_msg(std::move(mt), std::forward<Handle>(hostActor));
+		}
+		else
+		{
+			assert(_msgBuff.size() < _msgBuff.fixed_size());
+			_msgBuff.push_lane(lane, std::move(mt));
+		}
+	}
+
+	void push_lane_msg(size_t lane, msg_type&& mt, const actor_handle& hostActor)
+	{
+		if (_closed) return;
+
+		if (_strand->running_in_this_thread())
+		{
+			send_lane_msg(lane, std::move(mt), hostActor);
+		}
+		else
+		{
+			_strand->post(std::bind([lane](actor_handle& hostActor, const std::shared_ptr<MsgPool_>& sharedThis, msg_type& msg)
+			{
+				sharedThis->send_lane_msg(lane, std::move(msg), std::move(hostActor));
+			}, hostActor, _weakThis.lock(), std::move(mt)));
+		}
+	}
+
+	template <typename Handle, typename... Args>
+	void emplace_msg(Handle&& hostActor, Args&&... args)
+	{
+		if (_closed) return;
+
+		if (_waiting)
+		{
+			send_msg(msg_type(std::forward<Args>(args)...), std::forward<Handle>(hostActor));
+		}
+		else
+		{
+			assert(_msgBuff.size() < _msgBuff.fixed_size());
+			_msgBuff.push_back(emplace_tag(), std::forward<Args>(args)...);
+		}
+	}
+
+	template <typename... Args>
+	void push_emplace_msg(const actor_handle& hostActor, Args&&... args)
+	{
+		if (_closed) return;
+
+		if (_strand->running_in_this_thread())
+		{
+			emplace_msg(hostActor, std::forward<Args>(args)...);
+		}
+		else
+		{
+			_strand->post(std::bind([](actor_handle& hostActor, const std::shared_ptr<MsgPool_>& sharedThis, RM_CREF(Args)&... args)
+			{
+				sharedThis->emplace_msg(std::move(hostActor), std::move(args)...);
+			}, hostActor, _weakThis.lock(), std::forward<Args>(args)...));
+		}
+	}
+
 	void _lost_msg(actor_handle&& hostActor)
 	{
 		if (_closed) return;
@@ -1676,9 +2520,19 @@ private:
 		compHandler._msgPump = msgPump;
 		_sendCount = 0;
 		_waiting = false;
+		set_lanes(msgPump->_laneNum, msgPump->_defaultLane, msgPump->_starveLimit);
 		return compHandler;
 	}
 
+	void set_lanes(size_t laneNum, size_t defaultLane, size_t starveLimit)
+	{
+		assert(_strand->running_in_this_thread());
+		if (!_msgBuff.same_lanes(laneNum, defaultLane, starveLimit))
+		{
+			_msgBuff.enable_lanes(laneNum, defaultLane, starveLimit);
+		}
+	}
+
 	void disconnect()
 	{
 		assert(_strand->running_in_this_thread());
@@ -1708,7 +2562,7 @@ private:
 	std::weak_ptr<MsgPool_> _weakThis;
 	shared_strand _strand;
 	std::shared_ptr<msg_pump_type> _msgPump;
-	msg_queue<msg_pck> _msgBuff;
+	lane_msg_queue<msg_pck> _msgBuff;
 	unsigned char _sendCount;
 	bool _waiting : 1;
 	bool _closed : 1;
@@ -1762,11 +2616,13 @@ class MsgPoolVoid_ :public MsgPoolBase_
 	friend my_actor;
 	friend MsgPumpVoid_;
 	friend post_type;
+	friend multicast_actor_msg<>;
 protected:
 	MsgPoolVoid_(const shared_strand& strand);
 	virtual ~MsgPoolVoid_();
 protected:
 	void send_msg(actor_handle&& hostActor);
+	void send_msg(const actor_handle& hostActor);
 	void push_msg(const actor_handle& hostActor);
 	void lost_msg(actor_handle&& hostActor);
 	void _lost_msg(actor_handle&& hostActor);
@@ -1986,6 +2842,7 @@ template <typename... ARGS>
 class post_actor_msg
 {
 	typedef MsgPool_<ARGS...> msg_pool_type;
+	friend multicast_actor_msg<ARGS...>;
 public:
 	post_actor_msg(){}
 #ifdef ENABLE_CHECK_LOST
@@ -2039,9 +2896,32 @@ public:
 
 	void operator()() const
 	{
-		static_assert(sizeof...(ARGS) == 0, "");
+		static_assert(sizeof...(ARGS) == 0, "");
+		assert(!empty());
+		_msgPool->push_msg(_hostActor);
+	}
+
+	/*!
+	@brief 用参数在消息池队列节点中直接构造消息
+	*/
+	template <typename... Args>
+	void emplace(Args&&... args) const
+	{
+		static_assert(sizeof...(ARGS) == sizeof...(Args), "");
+		assert(!empty());
+		_msgPool->push_emplace_msg(_hostActor, std::forward<Args>(args)...);
+	}
+
+	/*!
+	@brief 发送到接收方消息泵的指定优先级通道，通道0优先级最高，见 my_actor::msg_pump_lanes
+	*/
+	template <typename... Args>
+	void post_lane(size_t lane, Args&&... args) const
+	{
+		static_assert(sizeof...(ARGS) == sizeof...(Args), "");
+		static_assert(sizeof...(ARGS) != 0, "");
 		assert(!empty());
-		_msgPool->push_msg(_hostActor);
+		_msgPool->push_lane_msg(lane, std::tuple<TYPE_PIPE(ARGS)...>(std::forward<Args>(args)...), _hostActor);
 	}
 
 	std::function<void(ARGS...)> case_func() const
@@ -2079,6 +2959,199 @@ private:
 	std::shared_ptr<CheckPumpLost_> _autoCheckLost;//必须在_msgPool下面
 #endif
 };
+
+/*!
+@brief 多播消息通知，接收者按消息池所在strand分组，每次通知每个strand只投递一次；
+消息在发送方只构造一次，由各strand共享只读，在目标strand上逐个复制给接收者，
+大消息体宜用 std::shared_ptr<const T> 作为消息类型
+*/
+template <typename... ARGS>
+class multicast_actor_msg
+{
+	typedef MsgPool_<ARGS...> msg_pool_type;
+	typedef post_actor_msg<ARGS...> post_type;
+	typedef std::tuple<TYPE_PIPE(ARGS)...> msg_type;
+	typedef std::vector<post_type> strand_group;
+
+	struct group_node
+	{
+		group_node()
+		:_shared(false) {}
+
+		shared_strand _strand;
+		std::shared_ptr<strand_group> _dests;
+		mutable bool _shared;
+	};
+public:
+	multicast_actor_msg() {}
+
+	multicast_actor_msg(const multicast_actor_msg& s)
+		:_groups(s._groups)
+	{
+		mark_shared(s);
+	}
+
+	multicast_actor_msg(multicast_actor_msg&& s)
+		:_groups(std::move(s._groups)) {}
+
+	void operator =(const multicast_actor_msg& s)
+	{
+		_groups = s._groups;
+		mark_shared(s);
+	}
+
+	void operator =(multicast_actor_msg&& s)
+	{
+		_groups = std::move(s._groups);
+	}
+public:
+	/*!
+	@brief 添加一个接收者
+	*/
+	void add(const post_type& dst)
+	{
+		assert(!dst.empty());
+		const shared_strand& strand = dst._msgPool->_strand;
+		for (size_t i = 0; i < _groups.size(); i++)
+		{
+			if (_groups[i]._strand == strand)
+			{
+				writable(_groups[i]).push_back(dst);
+				return;
+			}
+		}
+		group_node node;
+		node._strand = strand;
+		node._dests = std::make_shared<strand_group>();
+		node._dests->push_back(dst);
+		_groups.push_back(std::move(node));
+	}
+
+	/*!
+	@brief 删除一个接收者
+	*/
+	bool remove(const post_type& dst)
+	{
+		for (size_t i = 0; i < _groups.size(); i++)
+		{
+			const strand_group& dests = *_groups[i]._dests;
+			for (size_t j = 0; j < dests.size(); j++)
+			{
+				if (dests[j]._msgPool == dst._msgPool)
+				{
+					strand_group& wdests = writable(_groups[i]);
+					wdests.erase(wdests.begin() + j);
+					if (wdests.empty())
+					{
+						_groups.erase(_groups.begin() + i);
+					}
+					return true;
+				}
+			}
+		}
+		return false;
+	}
+
+	template <typename... Args>
+	void operator()(Args&&... args) const
+	{
+		static_assert(sizeof...(ARGS) == sizeof...(Args), "");
+		std::shared_ptr<const msg_type> msg = std::make_shared<msg_type>(std::forward<Args>(args)...);
+		for (size_t i = 0; i < _groups.size(); i++)
+		{
+			const group_node& node = _groups[i];
+			if (node._strand->running_in_this_thread())
+			{
+				deliver(*node._dests, *msg);
+			}
+			else
+			{
+				node._shared = true;
+				node._strand->post(std::bind([](const std::shared_ptr<strand_group>& dests, const std::shared_ptr<const msg_type>& msg)
+				{
+					deliver(*dests, *msg);
+				}, node._dests, msg));
+			}
+		}
+	}
+
+	/*!
+	@brief 接收者个数
+	*/
+	size_t size() const
+	{
+		size_t res = 0;
+		for (size_t i = 0; i < _groups.size(); i++)
+		{
+			res += _groups[i]._dests->size();
+		}
+		return res;
+	}
+
+	/*!
+	@brief 接收者分布的strand个数
+	*/
+	size_t strand_count() const
+	{
+		return _groups.size();
+	}
+
+	bool empty() const
+	{
+		return _groups.empty();
+	}
+
+	void clear()
+	{
+		_groups.clear();
+	}
+private:
+	/*!
+	@brief 分组投递到其它strand或被复制后即视为共享，只读；修改前先复制一份自己独占的
+	(所有标记都只在本对象的使用线程中读写，不依赖引用计数判断)
+	*/
+	static strand_group& writable(group_node& node)
+	{
+		if (node._shared)
+		{
+			node._dests = std::make_shared<strand_group>(*node._dests);
+			node._shared = false;
+		}
+		return *node._dests;
+	}
+
+	void mark_shared(const multicast_actor_msg& s)
+	{
+		for (size_t i = 0; i < _groups.size(); i++)
+		{
+			_groups[i]._shared = true;
+			s._groups[i]._shared = true;
+		}
+	}
+
+	static void deliver(const strand_group& dests, const msg_type& msg)
+	{
+		for (size_t i = 0; i < dests.size(); i++)
+		{
+			const post_type& dst = dests[i];
+			assert(dst._msgPool->_strand->running_in_this_thread());
+			send(dst._msgPool.get(), msg, dst._hostActor, std::integral_constant<bool, 0 == sizeof...(ARGS)>());
+		}
+	}
+
+	//只在接收者正在等待时才复制actor_handle
+	static void send(msg_pool_type* msgPool, const msg_type& msg, const actor_handle& hostActor, std::false_type)
+	{
+		msgPool->send_msg(msg_type(msg), hostActor);
+	}
+
+	static void send(msg_pool_type* msgPool, const msg_type&, const actor_handle& hostActor, std::true_type)
+	{
+		((MsgPoolVoid_*)msgPool)->send_msg(hostActor);
+	}
+private:
+	std::vector<group_node> _groups;
+};
 //////////////////////////////////////////////////////////////////////////
 
 class MutexBlock_
@@ -4314,7 +5387,7 @@ private:
 	actor_handle _actor;
 	trig_handle<> _quiteAth;
 	std::list<actor_handle>::iterator _actorIt;
-	std::list<std::function<void()> >::iterator _athIt;
+	std::list<small_handler<void()> >::iterator _athIt;
 	bool _started : 1;
 	bool _quited : 1;
 	NONE_COPY(child_handle);
@@ -4432,44 +5505,26 @@ class my_actor : public ActorTimerFace_
 			:_isSuspend(isSuspend), _h(std::forward<Handler>(h)) {}
 
 		bool _isSuspend;
-		std::function<void()> _h;
+		small_handler<void()> _h;
 		NONE_COPY(suspend_resume_option);
 		RVALUE_CONSTRUCT2(suspend_resume_option, _isSuspend, _h);
 	};
 
 	struct msg_pool_status
 	{
-#if (_WIN64 || __x86_64__ || _ARM64)
-		struct id_key
-		{
-			id_key(const size_t hash, const int id)
-			:_id(((unsigned long long)id << 56) | hash) { assert(0 == ((0xFFLL << 56) & hash)); }
-
-			operator unsigned long long() const
-			{
-				return _id;
-			}
-
-			const unsigned long long _id;
-		};
-#else
-		struct id_key
+		/*!
+		@brief 消息池表的键，低24位为消息类型编号，高8位为id，由flat_id_map散列后定位
+		*/
+		template <typename... Args>
+		static unsigned type_key(const int id)
 		{
-			id_key(const size_t hash, const int id)
-			:_id(((unsigned long long)id << 32) | hash) {}
-
-			operator unsigned long long() const
-			{
-				return _id;
-			}
-
-			const unsigned long long _id;
-		};
-#endif
-
-		msg_pool_status()
-			:_msgTypeMap(*_msgTypeMapAll) {}
+			assert(id >= 0 && id < 256);
+			const unsigned slot = type_slot<Args...>::index();
+			assert(slot < (1 << 24));
+			return ((unsigned)id << 24) | slot;
+		}
 
+		msg_pool_status() {}
 		~msg_pool_status() {}
 
 		struct pck_base
@@ -4580,16 +5635,59 @@ class my_actor : public ActorTimerFace_
 			NONE_COPY(pck)
 		};
 
+		/*!
+		@brief 遍历代理链时记录已加锁的节点，代理层数不受限，16层以内不分配内存
+		*/
+		struct lock_chain
+		{
+			lock_chain()
+				:_size(0) {}
+
+			void push(pck_base* pck)
+			{
+				if (_size < fixed_size)
+				{
+					_fixed[_size] = pck;
+				}
+				else
+				{
+					_overflow.push_back(pck);
+				}
+				_size++;
+			}
+
+			void unlock_all(my_actor* self)
+			{
+				while (_size)
+				{
+					if (--_size < fixed_size)
+					{
+						_fixed[_size]->unlock(self);
+					}
+					else
+					{
+						_overflow.back()->unlock(self);
+						_overflow.pop_back();
+					}
+				}
+			}
+
+			enum { fixed_size = 16 };
+			pck_base* _fixed[fixed_size];
+			std::vector<pck_base*> _overflow;
+			size_t _size;
+			NONE_COPY(lock_chain)
+		};
+
 		void clear(my_actor* self)
 		{
-			for (auto it = _msgTypeMap.begin(); it != _msgTypeMap.end(); ++it) { it->second->_amutex.quited_lock(self); }
-			for (auto it = _msgTypeMap.begin(); it != _msgTypeMap.end(); ++it) { it->second->close(); }
-			for (auto it = _msgTypeMap.begin(); it != _msgTypeMap.end(); ++it) { it->second->_amutex.quited_unlock(self); }
+			_msgTypeMap.for_each([self](unsigned, std::shared_ptr<pck_base>& pck) { pck->_amutex.quited_lock(self); });
+			_msgTypeMap.for_each([](unsigned, std::shared_ptr<pck_base>& pck) { pck->close(); });
+			_msgTypeMap.for_each([self](unsigned, std::shared_ptr<pck_base>& pck) { pck->_amutex.quited_unlock(self); });
 			_msgTypeMap.clear();
 		}
 
-		msg_map_shared_alloc<id_key, std::shared_ptr<pck_base> > _msgTypeMap;
-		static msg_map_shared_alloc<id_key, std::shared_ptr<pck_base> >::shared_node_alloc* _msgTypeMapAll;
+		flat_id_map<std::shared_ptr<pck_base> > _msgTypeMap;
 	};
 
 	template <typename R>
@@ -5179,12 +6277,12 @@ public:
 	*/
 	const std::list<actor_handle>& children();
 public:
-	typedef std::list<std::function<void()> >::iterator quit_iterator;
+	typedef std::list<small_handler<void()> >::iterator quit_iterator;
 
 	/*!
 	@brief 注册一个资源释放函数，在强制准备退出Actor时执行
 	*/
-	quit_iterator regist_quit_executor(std::function<void()> quitHandler);
+	quit_iterator regist_quit_executor(small_handler<void()> quitHandler);
 
 	/*!
 	@brief 注销资源释放函数
@@ -5570,8 +6668,7 @@ private:
 					overtime = true;
 					th();
 				});
-				push_yield();
-				if (overtime)
+				if (push_yield_status() || overtime)
 				{
 					return false;
 				}
@@ -5749,6 +6846,32 @@ public:
 		timed_wait_msg_invoke<Args...>(-1, amh, h);
 	}
 
+	/*!
+	@brief 从消息句柄中提取消息，不移出消息，返回消息在句柄队列中的引用，下次从该句柄提取消息前有效
+	@param ms 超时时间
+	@return 超时返回NULL
+	*/
+	template <typename... Args>
+	__yield_interrupt std::tuple<TYPE_PIPE(Args)...>* timed_wait_msg_ref(int ms, msg_handle<Args...>& amh)
+	{
+		assert_enter();
+		DstReceiverLend_<Args...> dstRec;
+		if (_timed_wait_msg(amh, dstRec, ms))
+		{
+			return dstRec._msg;
+		}
+		return NULL;
+	}
+
+	template <typename... Args>
+	__yield_interrupt std::tuple<TYPE_PIPE(Args)...>& wait_msg_ref(msg_handle<Args...>& amh)
+	{
+		assert_enter();
+		DstReceiverLend_<Args...> dstRec;
+		_wait_msg(amh, dstRec);
+		return *dstRec._msg;
+	}
+
 	/*!
 	@brief 等待并忽略掉一个消息
 	*/
@@ -6104,6 +7227,99 @@ public:
 		timed_wait_trig_invoke<Args...>(-1, ath, h);
 	}
 
+	/*!
+	@brief 发起一个请求，h(ask_reply<R...>&&)把应答函数交给服务方
+	@param ms 超时时间，小于0不超时，从发起请求时开始计算(绝对截止时间)，由ask_box内所有请求共用的截止时间堆判定，
+	截止时间到达后在下次ask_wait/ask_wait_any/ask_wait_all时标记为超时
+	@return 请求句柄，用ask_wait/ask_wait_any/ask_wait_all等待
+	*/
+	template <typename Handler, typename... R>
+	ask_future<R...> ask(ask_box<R...>& box, int ms, Handler&& h)
+	{
+		assert_enter();
+		AskCore_<R...>& core = *box._core;
+		core.bind(this);
+		ask_future<R...> f = core.new_ask(ms >= 0 ? get_tick_us() + (long long)ms * 1000 : -1);
+		h(ask_reply<R...>(box._core, f));
+		return f;
+	}
+
+	/*!
+	@brief 等待一个请求完成并取出应答，超时或句柄已失效返回false
+	*/
+	template <typename... R, typename... Outs>
+	__yield_interrupt bool ask_wait(ask_box<R...>& box, const ask_future<R...>& f, Outs&... res)
+	{
+		assert_enter();
+		_ask_wait(*box._core, (int)f._idx, f);
+		return box.take(f, res...);
+	}
+
+	/*!
+	@brief 等待任一请求完成(应答或超时)，用ask_box::take取出结果，没有未取出的请求时返回false
+	*/
+	template <typename... R>
+	__yield_interrupt bool ask_wait_any(ask_box<R...>& box, ask_future<R...>& f)
+	{
+		assert_enter();
+		AskCore_<R...>& core = *box._core;
+		if (!core.has_done() && !core._pending)
+		{
+			return false;
+		}
+		_ask_wait(core, AskCore_<R...>::wait_any, f);
+		f = core.pop_done();
+		return true;
+	}
+
+	/*!
+	@brief 等待全部请求完成(应答或超时)，用ask_box::take取出结果
+	*/
+	template <typename... R>
+	__yield_interrupt void ask_wait_all(ask_box<R...>& box)
+	{
+		assert_enter();
+		_ask_wait(*box._core, AskCore_<R...>::wait_all, ask_future<R...>());
+	}
+private:
+	template <typename... R>
+	void _ask_wait(AskCore_<R...>& core, int target, const ask_future<R...>& f)
+	{
+		assert(!core._host || core._host == this);
+		BREAK_OF_SCOPE_EXEC(core._waiting = false);
+		while (true)
+		{
+			core.expire(get_tick_us());
+			if (core.satisfied(target, f))
+			{
+				return;
+			}
+			const long long deadlineUs = core.next_deadline();
+			core._waitIdx = target;
+			core._waiting = true;
+			if (deadlineUs >= 0)
+			{
+				bool overtime = false;
+				deadline_trig(deadlineUs, [&]
+				{
+					overtime = true;
+					core._waiting = false;
+					pull_yield();
+				});
+				push_yield();
+				if (!overtime)
+				{
+					cancel_delay_trig();
+				}
+			}
+			else
+			{
+				push_yield();
+			}
+		}
+	}
+public:
+
 	/*!
 	@brief 等待并忽略掉一个消息
 	*/
@@ -6167,10 +7383,10 @@ private:
 	{
 		assert(id >= 0 && id < 256);
 		typedef msg_pool_status::pck<Args...> pck_type;
-		msg_pool_status::id_key typeID(type_hash<Args...>::hash_code(), id);
+		const unsigned typeID = msg_pool_status::type_key<Args...>(id);
 		if (make)
 		{
-			auto& res = host->_msgPoolStatus._msgTypeMap.insert(make_pair(typeID, std::shared_ptr<pck_type>())).first->second;
+			std::shared_ptr<msg_pool_status::pck_base>& res = host->_msgPoolStatus._msgTypeMap.insert(typeID);
 			if (!res)
 			{
 				res = std::make_shared<pck_type>(host);
@@ -6178,11 +7394,11 @@ private:
 			assert(std::dynamic_pointer_cast<pck_type>(res));
 			return std::static_pointer_cast<pck_type>(res);
 		}
-		auto it = host->_msgPoolStatus._msgTypeMap.find(typeID);
-		if (it != host->_msgPoolStatus._msgTypeMap.end())
+		std::shared_ptr<msg_pool_status::pck_base>* const res = host->_msgPoolStatus._msgTypeMap.find(typeID);
+		if (res)
 		{
-			assert(std::dynamic_pointer_cast<pck_type>(it->second));
-			return std::static_pointer_cast<pck_type>(it->second);
+			assert(std::dynamic_pointer_cast<pck_type>(*res));
+			return std::static_pointer_cast<pck_type>(*res);
 		}
 		return std::shared_ptr<pck_type>();
 	}
@@ -6226,8 +7442,7 @@ private:
 	template <typename... Args>
 	static void clear_msg_list(my_actor* const host, const std::shared_ptr<msg_pool_status::pck<Args...>>& msgPck)
 	{
-		size_t stackl = 0;
-		msg_pool_status::pck<Args...>* uStack[16];
+		msg_pool_status::lock_chain uStack;
 		msg_pool_status::pck<Args...>* pckIt = msgPck.get();
 		while (pckIt->_next)
 		{
@@ -6235,8 +7450,7 @@ private:
 			pckIt->_msgPool.reset();
 			pckIt = pckIt->_next.get();
 			pckIt->lock(host);
-			assert(stackl < 15);
-			uStack[stackl++] = pckIt;
+			uStack.push(pckIt);
 		}
 		if (!pckIt->is_closed())
 		{
@@ -6244,10 +7458,7 @@ private:
 			disconnect_pump<Args...>(host, msgPool_, pckIt->_msgPump);
 			msgPool_.reset();
 		}
-		while (stackl)
-		{
-			uStack[--stackl]->unlock(host);
-		}
+		uStack.unlock_all(host);
 	}
 
 	/*!
@@ -6258,8 +7469,7 @@ private:
 	{
 		typedef typename MsgPool_<Args...>::pump_handler pump_handler;
 
-		size_t stackl = 0;
-		msg_pool_status::pck<Args...>* uStack[16];
+		msg_pool_status::lock_chain uStack;
 		msg_pool_status::pck<Args...>* pckIt = msgPck.get();
 		while (pckIt->_next)
 		{
@@ -6267,8 +7477,7 @@ private:
 			pckIt->_msgPool = newPool;
 			pckIt = pckIt->_next.get();
 			pckIt->lock(this);
-			assert(stackl < 15);
-			uStack[stackl++] = pckIt;
+			uStack.push(pckIt);
 		}
 		if (!pckIt->is_closed())
 		{
@@ -6298,10 +7507,7 @@ private:
 				}
 			}
 		}
-		while (stackl)
-		{
-			uStack[--stackl]->unlock(this);
-		}
+		uStack.unlock_all(this);
 	}
 private:
 	/*!
@@ -6504,20 +7710,20 @@ public:
 		assert_enter();
 		assert(id >= 0 && id < 256);
 		typedef msg_pool_status::pck<Args...> pck_type;
-		msg_pool_status::id_key typeID(type_hash<Args...>::hash_code(), id);
-		auto it = _msgPoolStatus._msgTypeMap.find(typeID);
-		if (_msgPoolStatus._msgTypeMap.end() != it)
+		const unsigned typeID = msg_pool_status::type_key<Args...>(id);
+		std::shared_ptr<msg_pool_status::pck_base>* const res = _msgPoolStatus._msgTypeMap.find(typeID);
+		if (res)
 		{
 			lock_suspend();
 			lock_quit();
-			assert(std::dynamic_pointer_cast<pck_type>(it->second));
-			std::shared_ptr<pck_type> msgPck = std::static_pointer_cast<pck_type>(it->second);
+			assert(std::dynamic_pointer_cast<pck_type>(*res));
+			std::shared_ptr<pck_type> msgPck = std::static_pointer_cast<pck_type>(*res);
 			msgPck->lock(this);
 			auto msgPool = msgPck->_msgPool;
 			clear_msg_list<Args...>(this, msgPck);
 			msgPck->_msgPool = msgPool;
 			msgPck->clear();
-			_msgPoolStatus._msgTypeMap.erase(it);
+			_msgPoolStatus._msgTypeMap.erase(typeID);
 			msgPck->unlock(this);
 			unlock_quit();
 			unlock_suspend();
@@ -6943,8 +8149,7 @@ private:
 					overtime = true;
 					th();
 				});
-				push_yield();
-				if (overtime)
+				if (push_yield_status() || overtime)
 				{
 					return false;
 				}
@@ -7034,8 +8239,7 @@ private:
 					overtime = true;
 					pull_yield();
 				});
-				push_yield();
-				if (overtime)
+				if (push_yield_status() || overtime)
 				{
 					return false;
 				}
@@ -7244,6 +8448,51 @@ public:
 		return pump._handle->snap_size();
 	}
 
+	/*!
+	@brief 设置消息泵的优先级通道，通道0优先级最高，pump_msg总是先取高优先级通道的消息，
+	普通发送进入默认通道，post_actor_msg::post_lane 发送到指定通道；设置随消息泵保留，重新连接后依然有效，
+	已排队的消息并入默认通道
+	@param laneNum 通道数，1为关闭
+	@param defaultLane 默认通道
+	@param starveLimit 连续取出starveLimit条高优先级消息后，若低优先级通道有消息，则取一条低优先级消息，0为严格按优先级
+	*/
+	template <typename... Args>
+	__yield_interrupt void msg_pump_lanes(const msg_pump_handle<Args...>& pump, size_t laneNum = msg_lane::count, size_t defaultLane = msg_lane::normal, size_t starveLimit = 64)
+	{
+		static_assert(sizeof...(Args) != 0, "");
+		assert(!pump.check_closed());
+		assert(laneNum && defaultLane < laneNum);
+		lock_quit();
+		//connect_pump在消息池strand中读取通道设置，且总是在持有pck锁时调用，
+		//所以已连接时只在消息池strand中修改，未连接时持锁修改
+		auto msgPck = msg_pool_pck<Args...>(pump._id, this, false);
+		assert(msgPck);
+		msgPck->lock(this);
+		auto pump_ = pump._handle;
+		if (!pump_->_pumpHandler.empty())
+		{
+			auto msgPool = pump_->_pumpHandler._thisPool;
+			send(msgPool->_strand, [&]
+			{
+				pump_->_laneNum = laneNum;
+				pump_->_defaultLane = defaultLane;
+				pump_->_starveLimit = starveLimit;
+				if (msgPool->_msgPump.get() == pump_)
+				{
+					msgPool->set_lanes(laneNum, defaultLane, starveLimit);
+				}
+			});
+		}
+		else
+		{
+			pump_->_laneNum = laneNum;
+			pump_->_defaultLane = defaultLane;
+			pump_->_starveLimit = starveLimit;
+		}
+		msgPck->unlock(this);
+		unlock_quit();
+	}
+
 	/*!
 	@brief 超时等待通知句柄连接
 	*/
@@ -7342,16 +8591,14 @@ public:
 		if (msgPck)
 		{
 			msgPck->lock(this);
-			size_t stackl = 0;
-			msg_pool_status::pck<Args...>* uStack[16];
+			msg_pool_status::lock_chain uStack;
 			msg_pool_status::pck<Args...>* pckIt = msgPck.get();
 			while (true)
 			{
 				if (pckIt->_next)
 				{
-					assert(stackl < 15);
 					pckIt = pckIt->_next.get();
-					uStack[stackl++] = pckIt;
+					uStack.push(pckIt);
 					pckIt->lock(this);
 				}
 				else
@@ -7361,10 +8608,7 @@ public:
 					{
 						r = pckIt->_hostActor->shared_from_this();
 					}
-					while (stackl)
-					{
-						uStack[--stackl]->unlock(this);
-					}
+					uStack.unlock_all(this);
 					msgPck->unlock(this);
 					unlock_quit();
 					unlock_suspend();
@@ -7836,7 +9080,7 @@ public:
 	/*!
 	@brief 强制退出该Actor，不可滥用，有可能会造成资源泄漏，完成后回调
 	*/
-	void force_quit(std::function<void()> h = std::function<void()>());
+	void force_quit(small_handler<void()> h = small_handler<void()>());
 
 	/*!
 	@brief Actor是否已经开始运行
@@ -7853,6 +9097,18 @@ public:
 	*/
 	bool is_force();
 
+	/*!
+	@brief 开启后，Actor在 sleep/usleep/yield 或有超时的 timed_* 等待中收到强制退出时不再抛出异常，
+	而是直接返回(timed_* 返回false)，此后 quit_status() 为true，Actor应尽快从入口函数返回；
+	其它等待点仍以异常方式退出，在Actor内调用
+	*/
+	void enable_quit_status(bool enable = true);
+
+	/*!
+	@brief 是否已经以返回值方式收到强制退出，此后除上述等待点立即返回外，其它等待都将以异常方式退出
+	*/
+	bool quit_status();
+
 	/*!
 	@brief 是否在Actor中
 	*/
@@ -7906,12 +9162,12 @@ public:
 	/*!
 	@brief 暂停Actor
 	*/
-	void suspend(std::function<void()> h = std::function<void()>());
+	void suspend(small_handler<void()> h = small_handler<void()>());
 
 	/*!
 	@brief 恢复已暂停Actor
 	*/
-	void resume(std::function<void()> h = std::function<void()>());
+	void resume(small_handler<void()> h = small_handler<void()>());
 
 	/*!
 	@brief 触发通知，0 <= id < 32,64
@@ -7926,7 +9182,7 @@ public:
 	/*!
 	@brief 切换挂起/非挂起状态
 	*/
-	void switch_pause_play(std::function<void(bool)> h = std::function<void(bool)>());
+	void switch_pause_play(small_handler<void(bool)> h = small_handler<void(bool)>());
 
 	/*!
 	@brief 等待Actor退出，在Actor所依赖的ios无关线程中使用
@@ -7936,12 +9192,12 @@ public:
 	/*!
 	@brief 添加一个Actor结束通知
 	*/
-	void append_quit_notify(std::function<void()> h = std::function<void()>());
+	void append_quit_notify(small_handler<void()> h = small_handler<void()>());
 
 	/*!
 	@brief 添加一个Actor结束时在strand中执行的函数，后添加的先执行
 	*/
-	void append_quit_executor(std::function<void()> h = std::function<void()>());
+	void append_quit_executor(small_handler<void()> h = small_handler<void()>());
 
 	/*!
 	@brief 启动一堆Actor
@@ -8156,6 +9412,8 @@ private:
 	void pull_yield();
 	void pull_yield_after_quited();
 	void push_yield();
+	bool push_yield_status();
+	bool yield_check_quited();
 	void push_yield_after_quited();
 #if (__linux__ && ENABLE_DUMP_STACK)
 	static void dump_segmentation_fault(void* sp, size_t length);
@@ -8192,8 +9450,8 @@ private:
 	reusable_mem _reuMem;///<定时器内存管理
 	main_func _mainFunc;///<Actor入口
 	std::list<suspend_resume_option> _suspendResumeQueue;///<挂起/恢复操作队列
-	std::list<std::function<void()> > _quitCallback;///<Actor结束后的回调函数
-	std::list<std::function<void()> > _beginQuitExec;///<Actor准备退出时调用的函数，后注册的先执行
+	std::list<small_handler<void()> > _quitCallback;///<Actor结束后的回调函数
+	std::list<small_handler<void()> > _beginQuitExec;///<Actor准备退出时调用的函数，后注册的先执行
 	std::list<actor_handle> _childActorList;///<子Actor集合，子Actor都退出后，父Actor才能退出
 	int _timerStateCount;///<定时器计数
 	bool _timerStateSuspend : 1;///<定时器是否挂起
@@ -8210,6 +9468,8 @@ private:
 	bool _checkStack : 1;///<是否检测栈空间
 	bool _waitingQuit : 1;///<等待退出标记
 	bool _afterExitCleanStack : 1;///<结束后清栈
+	bool _quitStatusMode : 1;///<强制退出时在可返回状态的等待点以返回值代替异常
+	bool _quitStatus : 1;///<已经以返回值方式收到强制退出
 #ifdef PRINT_ACTOR_STACK
 public:
 	bool _checkStackFree : 1;///<是否检测堆栈过多
@@ -8224,8 +9484,8 @@ struct ActorReadyGo_
 {
 	ActorReadyGo_(shared_strand strand, size_t stackSize = MAX_STACKSIZE);
 	ActorReadyGo_(io_engine& ios, size_t stackSize = MAX_STACKSIZE);
-	ActorReadyGo_(shared_strand strand, std::function<void()> notify, size_t stackSize = MAX_STACKSIZE);
-	ActorReadyGo_(io_engine& ios, std::function<void()> notify, size_t stackSize = MAX_STACKSIZE);
+	ActorReadyGo_(shared_strand strand, small_handler<void()> notify, size_t stackSize = MAX_STACKSIZE);
+	ActorReadyGo_(io_engine& ios, small_handler<void()> notify, size_t stackSize = MAX_STACKSIZE);
 
 	template <typename Handler>
 	actor_handle operator -(AutoStackActor_<Handler>&& wrapActor)
@@ -8250,7 +9510,7 @@ struct ActorReadyGo_
 	}
 
 	shared_strand _strand;
-	std::function<void()> _notify;
+	small_handler<void()> _notify;
 	size_t _stackSize;
 	NONE_COPY(ActorReadyGo_);
 };
@@ -9,6 +9,20 @@
 #include <boost/asio/io_service.hpp>
 #include <boost/date_time/posix_time/posix_time.hpp>
 
+TypeSlotCount_::registry* TypeSlotCount_::_registry = NULL;
+
+unsigned TypeSlotCount_::alloc(size_t hashCode)
+{
+	assert(_registry);
+	std::lock_guard<std::mutex> lg(_registry->_mutex);
+	unsigned& slot = _registry->_slots[hashCode];
+	if (!slot)
+	{
+		slot = (unsigned)_registry->_slots.size();
+	}
+	return slot;
+}
+
 #ifdef WIN32
 #ifdef _MSC_VER
 #pragma comment(lib, "Winmm.lib")
@@ -5,6 +5,9 @@
 #include <functional>
 #include <memory>
 #include <list>
+#include <map>
+#include <mutex>
+#include <atomic>
 #include "try_move.h"
 
 #define BOND_NAME(__NAMEL__, __NAMER__) __NAMEL__ ## __NAMER__
@@ -449,6 +452,44 @@ struct type_hash<>
 	}
 };
 
+/*!
+@brief 类型编号分配器，以type_hash为键顺序分配编号，多个模块通过shared_initer共用同一张表，
+不同类型不会得到相同编号；表在install时创建，进程内一直保留(各模块缓存的编号始终有效)
+*/
+struct TypeSlotCount_
+{
+	struct registry
+	{
+		std::mutex _mutex;
+		std::map<size_t, unsigned> _slots;
+	};
+
+	static unsigned alloc(size_t hashCode);
+	static registry* _registry;
+};
+
+/*!
+@brief 根据类型，在首次使用时分配一个从1开始的顺序编号，之后直接读取
+*/
+template <typename... Types>
+struct type_slot
+{
+	static unsigned index()
+	{
+		unsigned slot = _slot.load(std::memory_order_acquire);
+		if (!slot)
+		{//并发首次使用时分配到的是同一个编号
+			slot = TypeSlotCount_::alloc(type_hash<Types...>::hash_code());
+			_slot.store(slot, std::memory_order_release);
+		}
+		return slot;
+	}
+private:
+	static std::atomic<unsigned> _slot;
+};
+//静态零初始化，不依赖函数内静态变量的线程安全初始化
+template <typename... Types> std::atomic<unsigned> type_slot<Types...>::_slot;
+
 /*!
 @brief 固定数组元素个数
 */
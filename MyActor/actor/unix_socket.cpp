@@ -0,0 +1,865 @@
+#include "unix_socket.h"
+
+#ifdef BOOST_ASIO_HAS_LOCAL_SOCKETS
+#include <sys/socket.h>
+#include <unistd.h>
+
+template <typename Protocol>
+UnixSocket_<Protocol>::UnixSocket_(io_engine& ios)
+:_socket(ios), _cancelCount(0)
+{
+}
+
+template <typename Protocol>
+UnixSocket_<Protocol>::~UnixSocket_()
+{
+	close();
+}
+
+template <typename Protocol>
+typename UnixSocket_<Protocol>::endpoint UnixSocket_<Protocol>::make_endpoint(const char* path)
+{
+	std::string name(path);
+	if (!name.empty() && '@' == name[0])
+	{
+		name[0] = '\0';
+	}
+	return endpoint(name);
+}
+
+template <typename Protocol>
+bool UnixSocket_<Protocol>::try_again(const result& res)
+{
+	return boost::asio::error::try_again == res.code || boost::asio::error::would_block == res.code;
+}
+
+template <typename Protocol>
+int UnixSocket_<Protocol>::native()
+{
+	return _socket.native_handle();
+}
+
+template <typename Protocol>
+typename UnixSocket_<Protocol>::result UnixSocket_<Protocol>::close()
+{
+	boost::system::error_code ec;
+	_socket.close(ec);
+	return result{ 0, ec.value(), !ec };
+}
+
+template <typename Protocol>
+typename UnixSocket_<Protocol>::result UnixSocket_<Protocol>::cancel()
+{
+	_cancelCount++;
+	boost::system::error_code ec;
+	_socket.cancel(ec);
+	return result{ 0, ec.value(), !ec };
+}
+
+template <typename Protocol>
+void UnixSocket_<Protocol>::timeout_cancel()
+{
+	//asio只能取消全部操作，不计入_cancelCount，被波及的另一方向操作在wait_ready中重试
+	boost::system::error_code ec;
+	_socket.cancel(ec);
+}
+
+template <typename Protocol>
+bool UnixSocket_<Protocol>::is_open()
+{
+	return _socket.is_open();
+}
+
+template <typename Protocol>
+typename UnixSocket_<Protocol>::result UnixSocket_<Protocol>::try_send_fds(const void* buff, size_t length, const int* fds, size_t fdCount)
+{
+	assert(fdCount <= UNIX_SCM_MAX_FDS);
+	if (fdCount && !length && std::is_same<Protocol, boost::asio::local::stream_protocol>::value)
+	{
+		assert(false);
+		return result{ 0, boost::asio::error::invalid_argument, false };
+	}
+	union
+	{
+		struct cmsghdr align;
+		char data[CMSG_SPACE(sizeof(int) * UNIX_SCM_MAX_FDS)];
+	} control;
+	struct iovec msg;
+	msg.iov_base = (void*)buff;
+	msg.iov_len = length;
+	struct msghdr mhdr;
+	memset(&mhdr, 0, sizeof(mhdr));
+	mhdr.msg_iov = &msg;
+	mhdr.msg_iovlen = 1;
+	if (fdCount)
+	{
+		mhdr.msg_control = control.data;
+		mhdr.msg_controllen = CMSG_SPACE(sizeof(int) * fdCount);
+		struct cmsghdr* cm = CMSG_FIRSTHDR(&mhdr);
+		cm->cmsg_level = SOL_SOCKET;
+		cm->cmsg_type = SCM_RIGHTS;
+		cm->cmsg_len = CMSG_LEN(sizeof(int) * fdCount);
+		memcpy(CMSG_DATA(cm), fds, sizeof(int) * fdCount);
+	}
+	while (true)
+	{
+		const ssize_t s = ::sendmsg(_socket.native_handle(), &mhdr, MSG_DONTWAIT | MSG_NOSIGNAL);
+		if (s >= 0)
+		{
+			return result{ (size_t)s, 0, true };
+		}
+		if (EINTR != errno)
+		{
+			return result{ 0, errno, false };
+		}
+	}
+}
+
+template <typename Protocol>
+typename UnixSocket_<Protocol>::result UnixSocket_<Protocol>::try_recv_fds(void* buff, size_t length, int* fds, size_t& fdCount)
+{
+	assert(fdCount <= UNIX_SCM_MAX_FDS);
+	union
+	{
+		struct cmsghdr align;
+		char data[CMSG_SPACE(sizeof(int) * UNIX_SCM_MAX_FDS)];
+	} control;
+	struct iovec msg;
+	msg.iov_base = buff;
+	msg.iov_len = length;
+	struct msghdr mhdr;
+	memset(&mhdr, 0, sizeof(mhdr));
+	mhdr.msg_iov = &msg;
+	mhdr.msg_iovlen = 1;
+	mhdr.msg_control = control.data;
+	mhdr.msg_controllen = CMSG_SPACE(sizeof(int) * fdCount);
+	const size_t maxCount = fdCount;
+	fdCount = 0;
+	ssize_t s;
+	while ((s = ::recvmsg(_socket.native_handle(), &mhdr, MSG_DONTWAIT | MSG_CMSG_CLOEXEC)) < 0)
+	{
+		if (EINTR != errno)
+		{
+			return result{ 0, errno, false };
+		}
+	}
+	for (struct cmsghdr* cm = CMSG_FIRSTHDR(&mhdr); cm; cm = CMSG_NXTHDR(&mhdr, cm))
+	{
+		if (SOL_SOCKET == cm->cmsg_level && SCM_RIGHTS == cm->cmsg_type)
+		{
+			const size_t ct = (cm->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+			for (size_t i = 0; i < ct; i++)
+			{
+				int fd;
+				memcpy(&fd, CMSG_DATA(cm) + i * sizeof(int), sizeof(int));
+				if (fdCount < maxCount)
+				{
+					fds[fdCount++] = fd;
+				}
+				else
+				{
+					::close(fd);
+				}
+			}
+		}
+	}
+	if (!s && length && std::is_same<Protocol, boost::asio::local::stream_protocol>::value)
+	{
+		return result{ 0, boost::asio::error::eof, false };
+	}
+	return result{ (size_t)s, 0, true };
+}
+
+template <typename Protocol>
+typename UnixSocket_<Protocol>::result UnixSocket_<Protocol>::send_fds(my_actor* host, const void* buff, size_t length, const int* fds, size_t fdCount)
+{
+	result res;
+	while (!(res = try_send_fds(buff, length, fds, fdCount)).ok)
+	{
+		if (!try_again(res))
+		{
+			return res;
+		}
+		res = wait_ready(host, -1, true);
+		if (!res.ok)
+		{
+			return res;
+		}
+	}
+	if (res.s < length)
+	{
+		//描述符已随首段发出，剩余部分按普通数据发送
+		result wr = do_io(host, -1, true, (char*)buff + res.s, length - res.s, true, NULL);
+		wr.s += res.s;
+		return wr;
+	}
+	return res;
+}
+
+template <typename Protocol>
+typename UnixSocket_<Protocol>::result UnixSocket_<Protocol>::recv_fds(my_actor* host, void* buff, size_t length, int* fds, size_t& fdCount)
+{
+	return timed_recv_fds(host, -1, buff, length, fds, fdCount);
+}
+
+template <typename Protocol>
+typename UnixSocket_<Protocol>::result UnixSocket_<Protocol>::timed_recv_fds(my_actor* host, int ms, void* buff, size_t length, int* fds, size_t& fdCount)
+{
+	const long long deadline = ms >= 0 ? get_tick_us() + (long long)ms * 1000 : -1;
+	const size_t maxCount = fdCount;
+	while (true)
+	{
+		fdCount = maxCount;
+		result res = try_recv_fds(buff, length, fds, fdCount);
+		if (res.ok || !try_again(res))
+		{
+			return res;
+		}
+		res = wait_ready(host, deadline, false);
+		if (!res.ok)
+		{
+			fdCount = 0;
+			return res;
+		}
+	}
+}
+
+template <typename Protocol>
+typename UnixSocket_<Protocol>::result UnixSocket_<Protocol>::do_io(my_actor* host, long long deadline, bool write, char* buff, size_t length, bool all, endpoint* remoteEndpoint)
+{
+	result res = { 0, 0, false };
+	while (true)
+	{
+		result tr = write ? try_send_same(buff + res.s, length - res.s, remoteEndpoint) : try_recv_same(buff + res.s, length - res.s, remoteEndpoint);
+		if (tr.ok)
+		{
+			res.s += tr.s;
+			if (!all || res.s == length)
+			{
+				res.ok = true;
+				return res;
+			}
+			continue;
+		}
+		if (!try_again(tr))
+		{
+			res.code = tr.code;
+			return res;
+		}
+		tr = wait_ready(host, deadline, write);
+		if (!tr.ok)
+		{
+			res.code = tr.code;
+			return res;
+		}
+	}
+}
+
+template <typename Protocol>
+typename UnixSocket_<Protocol>::result UnixSocket_<Protocol>::try_send_same(const void* buff, size_t length, const endpoint* remoteEndpoint)
+{
+	while (true)
+	{
+		const ssize_t s = remoteEndpoint
+			? ::sendto(_socket.native_handle(), buff, length, MSG_DONTWAIT | MSG_NOSIGNAL, (const struct sockaddr*)remoteEndpoint->data(), remoteEndpoint->size())
+			: ::send(_socket.native_handle(), buff, length, MSG_DONTWAIT | MSG_NOSIGNAL);
+		if (s >= 0)
+		{
+			return result{ (size_t)s, 0, true };
+		}
+		if (EINTR != errno)
+		{
+			return result{ 0, errno, false };
+		}
+	}
+}
+
+template <typename Protocol>
+typename UnixSocket_<Protocol>::result UnixSocket_<Protocol>::try_recv_same(void* buff, size_t length, endpoint* remoteEndpoint)
+{
+	while (true)
+	{
+		socklen_t nameLength = remoteEndpoint ? (socklen_t)remoteEndpoint->capacity() : 0;
+		const ssize_t s = remoteEndpoint
+			? ::recvfrom(_socket.native_handle(), buff, length, MSG_DONTWAIT, (struct sockaddr*)remoteEndpoint->data(), &nameLength)
+			: ::recv(_socket.native_handle(), buff, length, MSG_DONTWAIT);
+		if (s > 0 || (0 == s && (!length || !std::is_same<Protocol, boost::asio::local::stream_protocol>::value)))
+		{
+			if (remoteEndpoint)
+			{
+				remoteEndpoint->resize(nameLength);
+			}
+			return result{ (size_t)s, 0, true };
+		}
+		if (0 == s)
+		{
+			return result{ 0, boost::asio::error::eof, false };
+		}
+		if (EINTR != errno)
+		{
+			return result{ 0, errno, false };
+		}
+	}
+}
+
+template <typename Protocol>
+typename UnixSocket_<Protocol>::result UnixSocket_<Protocol>::try_msend_same(const endpoint* remoteEndpoints, size_t endpointStep, const void* const* buffs, const size_t* lengths, size_t count, size_t* bytes)
+{
+	result res = { 0, 0, false };
+#ifdef ENABLE_SCK_MULTI_IO
+	while (res.s < count)
+	{
+		struct iovec msgs[32];
+		struct mmsghdr mhdr[32];
+		size_t ct = 0;
+		for (; ct < fixed_array_length(msgs) && res.s + ct < count; ct++)
+		{
+			const size_t k = res.s + ct;
+			msgs[ct].iov_base = (void*)buffs[k];
+			msgs[ct].iov_len = lengths[k];
+			memset(&mhdr[ct], 0, sizeof(mhdr[ct]));
+			mhdr[ct].msg_hdr.msg_iov = &msgs[ct];
+			mhdr[ct].msg_hdr.msg_iovlen = 1;
+			if (remoteEndpoints)
+			{
+				mhdr[ct].msg_hdr.msg_name = (void*)remoteEndpoints[k * endpointStep].data();
+				mhdr[ct].msg_hdr.msg_namelen = remoteEndpoints[k * endpointStep].size();
+			}
+		}
+		const int pcks = ::sendmmsg(_socket.native_handle(), mhdr, (unsigned int)ct, MSG_DONTWAIT | MSG_NOSIGNAL);
+		if (pcks > 0)
+		{
+			if (bytes)
+			{
+				for (size_t j = 0; j < (size_t)pcks; j++)
+				{
+					bytes[res.s + j] = mhdr[j].msg_len;
+				}
+			}
+			res.s += pcks;
+			if ((size_t)pcks != ct && EINTR != errno)
+			{
+				break;
+			}
+			continue;
+		}
+		const int err = errno;
+		if (EINTR == err)
+		{
+			continue;
+		}
+		if (res.s && (EAGAIN == err || EWOULDBLOCK == err))
+		{
+			break;
+		}
+		res.code = err;
+		return res;
+	}
+#else
+	for (; res.s < count; res.s++)
+	{
+		result tr = try_send_same(buffs[res.s], lengths[res.s], remoteEndpoints ? remoteEndpoints + res.s * endpointStep : NULL);
+		if (!tr.ok)
+		{
+			if (res.s && try_again(tr))
+			{
+				break;
+			}
+			res.code = tr.code;
+			return res;
+		}
+		if (bytes)
+		{
+			bytes[res.s] = tr.s;
+		}
+	}
+#endif
+	res.ok = true;
+	return res;
+}
+
+template <typename Protocol>
+typename UnixSocket_<Protocol>::result UnixSocket_<Protocol>::try_mrecv_same(endpoint* remoteEndpoints, void* const* buffs, const size_t* lengths, size_t count, size_t* bytes)
+{
+	result res = { 0, 0, false };
+#ifdef ENABLE_SCK_MULTI_IO
+	while (res.s < count)
+	{
+		struct iovec msgs[32];
+		struct mmsghdr mhdr[32];
+		size_t ct = 0;
+		for (; ct < fixed_array_length(msgs) && res.s + ct < count; ct++)
+		{
+			const size_t k = res.s + ct;
+			msgs[ct].iov_base = buffs[k];
+			msgs[ct].iov_len = lengths[k];
+			memset(&mhdr[ct], 0, sizeof(mhdr[ct]));
+			mhdr[ct].msg_hdr.msg_iov = &msgs[ct];
+			mhdr[ct].msg_hdr.msg_iovlen = 1;
+			if (remoteEndpoints)
+			{
+				mhdr[ct].msg_hdr.msg_name = remoteEndpoints[k].data();
+				mhdr[ct].msg_hdr.msg_namelen = remoteEndpoints[k].capacity();
+			}
+		}
+		const int pcks = ::recvmmsg(_socket.native_handle(), mhdr, (unsigned int)ct, MSG_DONTWAIT, NULL);
+		if (pcks > 0)
+		{
+			for (size_t j = 0; j < (size_t)pcks; j++)
+			{
+				if (remoteEndpoints)
+				{
+					remoteEndpoints[res.s + j].resize(mhdr[j].msg_hdr.msg_namelen);
+				}
+				if (bytes)
+				{
+					bytes[res.s + j] = mhdr[j].msg_len;
+				}
+			}
+			res.s += pcks;
+			if ((size_t)pcks != ct)
+			{
+				break;
+			}
+			continue;
+		}
+		const int err = errno;
+		if (EINTR == err)
+		{
+			continue;
+		}
+		if (res.s && (EAGAIN == err || EWOULDBLOCK == err))
+		{
+			break;
+		}
+		res.code = err;
+		return res;
+	}
+#else
+	for (; res.s < count; res.s++)
+	{
+		result tr = try_recv_same(buffs[res.s], lengths[res.s], remoteEndpoints ? remoteEndpoints + res.s : NULL);
+		if (!tr.ok)
+		{
+			if (res.s && try_again(tr))
+			{
+				break;
+			}
+			res.code = tr.code;
+			return res;
+		}
+		if (bytes)
+		{
+			bytes[res.s] = tr.s;
+		}
+	}
+#endif
+	res.ok = true;
+	return res;
+}
+
+template <typename Protocol>
+typename UnixSocket_<Protocol>::result UnixSocket_<Protocol>::wait_ready(my_actor* host, long long deadline, bool write)
+{
+	int ms = 0;
+	if (deadline >= 0)
+	{
+		const long long remain = deadline - get_tick_us();
+		if (remain <= 0)
+		{
+			return result{ 0, boost::asio::error::timed_out, false };
+		}
+		ms = (int)((remain + 999) / 1000);
+	}
+	bool overtime = false;
+	boost::system::error_code ec;
+	size_t s = 0;
+	const unsigned cancelCount = _cancelCount;
+	my_actor::quit_guard qg(host);
+	if (ms > 0)
+	{
+		if (write)
+		{
+			_socket.async_send(boost::asio::null_buffers(), host->make_asio_timed_context(ms, [&]()
+			{
+				overtime = true;
+				timeout_cancel();
+			}, ec, s));
+		}
+		else
+		{
+			_socket.async_receive(boost::asio::null_buffers(), host->make_asio_timed_context(ms, [&]()
+			{
+				overtime = true;
+				timeout_cancel();
+			}, ec, s));
+		}
+	}
+	else if (write)
+	{
+		_socket.async_send(boost::asio::null_buffers(), host->make_asio_context(ec, s));
+	}
+	else
+	{
+		_socket.async_receive(boost::asio::null_buffers(), host->make_asio_context(ec, s));
+	}
+	if (overtime && ec)
+	{
+		return result{ 0, boost::asio::error::timed_out, false };
+	}
+	if (boost::asio::error::operation_aborted == ec && cancelCount == _cancelCount && _socket.is_open())
+	{
+		//另一方向操作超时取消波及，不是本操作的错误，返回后由调用方重新尝试
+		return result{ 0, 0, true };
+	}
+	return result{ 0, ec.value(), !ec };
+}
+
+template class UnixSocket_<boost::asio::local::stream_protocol>;
+template class UnixSocket_<boost::asio::local::datagram_protocol>;
+//////////////////////////////////////////////////////////////////////////
+
+unix_socket::unix_socket(io_engine& ios)
+:UnixSocket_(ios)
+{
+}
+
+unix_socket::~unix_socket()
+{
+}
+
+unix_socket::result unix_socket::pair(unix_socket& a, unix_socket& b)
+{
+	boost::system::error_code ec;
+	boost::asio::local::connect_pair(a._socket, b._socket, ec);
+	return result{ 0, ec.value(), !ec };
+}
+
+unix_socket::result unix_socket::connect(my_actor* host, const char* path)
+{
+	return connect(host, 0, make_endpoint(path));
+}
+
+unix_socket::result unix_socket::connect(my_actor* host, const endpoint& remoteEndpoint)
+{
+	return connect(host, 0, remoteEndpoint);
+}
+
+unix_socket::result unix_socket::timed_connect(my_actor* host, int ms, const char* path)
+{
+	return connect(host, ms, make_endpoint(path));
+}
+
+unix_socket::result unix_socket::timed_connect(my_actor* host, int ms, const endpoint& remoteEndpoint)
+{
+	return connect(host, ms, remoteEndpoint);
+}
+
+unix_socket::result unix_socket::connect(my_actor* host, int ms, const endpoint& remoteEndpoint)
+{
+	bool overtime = false;
+	boost::system::error_code ec;
+	my_actor::quit_guard qg(host);
+	if (ms > 0)
+	{
+		_socket.async_connect(remoteEndpoint, host->make_asio_timed_context(ms, [&]()
+		{
+			overtime = true;
+			timeout_cancel();
+		}, ec));
+	}
+	else
+	{
+		_socket.async_connect(remoteEndpoint, host->make_asio_context(ec));
+	}
+	return (overtime && ec) ? result{ 0, boost::asio::error::timed_out, false } : result{ 0, ec.value(), !ec };
+}
+
+unix_socket::result unix_socket::read_some(my_actor* host, void* buff, size_t length)
+{
+	return do_io(host, -1, false, (char*)buff, length, false, NULL);
+}
+
+unix_socket::result unix_socket::read(my_actor* host, void* buff, size_t length)
+{
+	return do_io(host, -1, false, (char*)buff, length, true, NULL);
+}
+
+unix_socket::result unix_socket::write_some(my_actor* host, const void* buff, size_t length)
+{
+	return do_io(host, -1, true, (char*)buff, length, false, NULL);
+}
+
+unix_socket::result unix_socket::write(my_actor* host, const void* buff, size_t length)
+{
+	return do_io(host, -1, true, (char*)buff, length, true, NULL);
+}
+
+unix_socket::result unix_socket::timed_read_some(my_actor* host, int ms, void* buff, size_t length)
+{
+	return do_io(host, ms >= 0 ? get_tick_us() + (long long)ms * 1000 : -1, false, (char*)buff, length, false, NULL);
+}
+
+unix_socket::result unix_socket::timed_read(my_actor* host, int ms, void* buff, size_t length)
+{
+	return do_io(host, ms >= 0 ? get_tick_us() + (long long)ms * 1000 : -1, false, (char*)buff, length, true, NULL);
+}
+
+unix_socket::result unix_socket::timed_write(my_actor* host, int ms, const void* buff, size_t length)
+{
+	return do_io(host, ms >= 0 ? get_tick_us() + (long long)ms * 1000 : -1, true, (char*)buff, length, true, NULL);
+}
+
+unix_socket::result unix_socket::try_read_same(void* buff, size_t length)
+{
+	return try_recv_same(buff, length, NULL);
+}
+
+unix_socket::result unix_socket::try_write_same(const void* buff, size_t length)
+{
+	return try_send_same(buff, length, NULL);
+}
+//////////////////////////////////////////////////////////////////////////
+
+unix_acceptor::unix_acceptor(io_engine& ios)
+:_acceptor(ios)
+{
+}
+
+unix_acceptor::~unix_acceptor()
+{
+	close();
+}
+
+unix_acceptor::result unix_acceptor::open(const char* path, bool removeOld)
+{
+	if (_acceptor.is_open())
+	{
+		return result{ 0, 0, false };
+	}
+	if (removeOld && '@' != path[0])
+	{
+		::unlink(path);
+	}
+	try
+	{
+		_acceptor.open();
+		_acceptor.bind(unix_socket::make_endpoint(path));
+		_acceptor.listen();
+		_acceptor.non_blocking(true);
+		_path = '@' != path[0] ? path : "";
+		return result{ 0, 0, true };
+	}
+	catch (const boost::system::system_error& se)
+	{
+		boost::system::error_code ec;
+		_acceptor.close(ec);
+		return result{ 0, se.code().value(), false };
+	}
+}
+
+unix_acceptor::result unix_acceptor::close()
+{
+	boost::system::error_code ec;
+	_acceptor.close(ec);
+	if (!_path.empty())
+	{
+		::unlink(_path.c_str());
+		_path.clear();
+	}
+	return result{ 0, ec.value(), !ec };
+}
+
+bool unix_acceptor::is_open()
+{
+	return _acceptor.is_open();
+}
+
+unix_acceptor::result unix_acceptor::try_accept(unix_socket& socket)
+{
+	while (true)
+	{
+		const int fd = ::accept4(_acceptor.native_handle(), NULL, NULL, SOCK_CLOEXEC);
+		if (-1 != fd)
+		{
+			boost::system::error_code ec;
+			socket._socket.assign(boost::asio::local::stream_protocol(), fd, ec);
+			if (ec)
+			{
+				::close(fd);
+			}
+			return result{ 0, ec.value(), !ec };
+		}
+		if (EINTR != errno)
+		{
+			return result{ 0, errno, false };
+		}
+	}
+}
+
+unix_acceptor::result unix_acceptor::accept(my_actor* host, unix_socket& socket)
+{
+	return timed_accept(host, 0, socket);
+}
+
+unix_acceptor::result unix_acceptor::timed_accept(my_actor* host, int ms, unix_socket& socket)
+{
+	result res = try_accept(socket);
+	if (res.ok || !unix_socket::try_again(res))
+	{
+		return res;
+	}
+	bool overtime = false;
+	boost::system::error_code ec;
+	my_actor::quit_guard qg(host);
+	if (ms > 0)
+	{
+		_acceptor.async_accept(socket._socket, host->make_asio_timed_context(ms, [&]()
+		{
+			overtime = true;
+			boost::system::error_code ec;
+			_acceptor.cancel(ec);
+		}, ec));
+	}
+	else
+	{
+		_acceptor.async_accept(socket._socket, host->make_asio_context(ec));
+	}
+	return (overtime && ec) ? result{ 0, boost::asio::error::timed_out, false } : result{ 0, ec.value(), !ec };
+}
+//////////////////////////////////////////////////////////////////////////
+
+unix_dgram_socket::unix_dgram_socket(io_engine& ios)
+:UnixSocket_(ios)
+{
+}
+
+unix_dgram_socket::~unix_dgram_socket()
+{
+	if (!_path.empty())
+	{
+		::unlink(_path.c_str());
+	}
+}
+
+unix_dgram_socket::result unix_dgram_socket::pair(unix_dgram_socket& a, unix_dgram_socket& b)
+{
+	boost::system::error_code ec;
+	boost::asio::local::connect_pair(a._socket, b._socket, ec);
+	return result{ 0, ec.value(), !ec };
+}
+
+unix_dgram_socket::result unix_dgram_socket::open()
+{
+	boost::system::error_code ec;
+	_socket.open(boost::asio::local::datagram_protocol(), ec);
+	return result{ 0, ec.value(), !ec };
+}
+
+unix_dgram_socket::result unix_dgram_socket::open_bind(const char* path, bool removeOld)
+{
+	if (removeOld && '@' != path[0])
+	{
+		::unlink(path);
+	}
+	boost::system::error_code ec;
+	_socket.open(boost::asio::local::datagram_protocol(), ec);
+	if (!ec)
+	{
+		_socket.bind(make_endpoint(path), ec);
+		if (!ec)
+		{
+			_path = '@' != path[0] ? path : "";
+		}
+	}
+	return result{ 0, ec.value(), !ec };
+}
+
+unix_dgram_socket::result unix_dgram_socket::connect(const char* path)
+{
+	return connect(make_endpoint(path));
+}
+
+unix_dgram_socket::result unix_dgram_socket::connect(const endpoint& remoteEndpoint)
+{
+	boost::system::error_code ec;
+	_socket.connect(remoteEndpoint, ec);
+	return result{ 0, ec.value(), !ec };
+}
+
+unix_dgram_socket::result unix_dgram_socket::send(my_actor* host, const void* buff, size_t length)
+{
+	return do_io(host, -1, true, (char*)buff, length, false, NULL);
+}
+
+unix_dgram_socket::result unix_dgram_socket::send_to(my_actor* host, const endpoint& remoteEndpoint, const void* buff, size_t length)
+{
+	return do_io(host, -1, true, (char*)buff, length, false, (endpoint*)&remoteEndpoint);
+}
+
+unix_dgram_socket::result unix_dgram_socket::receive(my_actor* host, void* buff, size_t length)
+{
+	return do_io(host, -1, false, (char*)buff, length, false, NULL);
+}
+
+unix_dgram_socket::result unix_dgram_socket::receive_from(my_actor* host, endpoint& remoteEndpoint, void* buff, size_t length)
+{
+	return do_io(host, -1, false, (char*)buff, length, false, &remoteEndpoint);
+}
+
+unix_dgram_socket::result unix_dgram_socket::timed_receive(my_actor* host, int ms, void* buff, size_t length)
+{
+	return do_io(host, ms >= 0 ? get_tick_us() + (long long)ms * 1000 : -1, false, (char*)buff, length, false, NULL);
+}
+
+unix_dgram_socket::result unix_dgram_socket::timed_receive_from(my_actor* host, int ms, endpoint& remoteEndpoint, void* buff, size_t length)
+{
+	return do_io(host, ms >= 0 ? get_tick_us() + (long long)ms * 1000 : -1, false, (char*)buff, length, false, &remoteEndpoint);
+}
+
+unix_dgram_socket::result unix_dgram_socket::try_send(const void* buff, size_t length)
+{
+	return try_send_same(buff, length, NULL);
+}
+
+unix_dgram_socket::result unix_dgram_socket::try_send_to(const endpoint& remoteEndpoint, const void* buff, size_t length)
+{
+	return try_send_same(buff, length, &remoteEndpoint);
+}
+
+unix_dgram_socket::result unix_dgram_socket::try_receive(void* buff, size_t length)
+{
+	return try_recv_same(buff, length, NULL);
+}
+
+unix_dgram_socket::result unix_dgram_socket::try_receive_from(endpoint& remoteEndpoint, void* buff, size_t length)
+{
+	return try_recv_same(buff, length, &remoteEndpoint);
+}
+
+unix_dgram_socket::result unix_dgram_socket::try_msend(const void* const* buffs, const size_t* lengths, size_t count, size_t* bytes)
+{
+	return try_msend_same(NULL, 0, buffs, lengths, count, bytes);
+}
+
+unix_dgram_socket::result unix_dgram_socket::try_msend_to(const endpoint& remoteEndpoint, const void* const* buffs, const size_t* lengths, size_t count, size_t* bytes)
+{
+	return try_msend_same(&remoteEndpoint, 0, buffs, lengths, count, bytes);
+}
+
+unix_dgram_socket::result unix_dgram_socket::try_msend_to(const endpoint* remoteEndpoints, const void* const* buffs, const size_t* lengths, size_t count, size_t* bytes)
+{
+	return try_msend_same(remoteEndpoints, 1, buffs, lengths, count, bytes);
+}
+
+unix_dgram_socket::result unix_dgram_socket::try_mreceive(void* const* buffs, const size_t* lengths, size_t count, size_t* bytes)
+{
+	return try_mrecv_same(NULL, buffs, lengths, count, bytes);
+}
+
+unix_dgram_socket::result unix_dgram_socket::try_mreceive_from(endpoint* remoteEndpoints, void* const* buffs, const size_t* lengths, size_t count, size_t* bytes)
+{
+	return try_mrecv_same(remoteEndpoints, buffs, lengths, count, bytes);
+}
+
+#endif
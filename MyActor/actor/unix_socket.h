@@ -0,0 +1,450 @@
+#ifndef __UNIX_SOCKET_H
+#define __UNIX_SOCKET_H
+
+#include <boost/asio/local/stream_protocol.hpp>
+#include <boost/asio/local/datagram_protocol.hpp>
+#include <boost/asio/local/connect_pair.hpp>
+#include <atomic>
+#include "actor_socket.h"
+
+#ifdef BOOST_ASIO_HAS_LOCAL_SOCKETS
+
+//单次SCM_RIGHTS最多传递的文件描述符个数
+#define UNIX_SCM_MAX_FDS 64
+
+class unix_acceptor;
+
+/*!
+@brief unix域socket公共部分，io先用MSG_DONTWAIT尝试直接完成，失败后再等待就绪重试
+*/
+template <typename Protocol>
+class UnixSocket_
+{
+public:
+	typedef socket_result result;
+	typedef typename Protocol::endpoint endpoint;
+protected:
+	UnixSocket_(io_engine& ios);
+	~UnixSocket_();
+public:
+	/*!
+	@brief 生成一个地址，以'@'开头时使用linux抽象命名空间
+	*/
+	static endpoint make_endpoint(const char* path);
+
+	/*!
+	@brief try_io操作失败是否是因为EAGAIN
+	*/
+	static bool try_again(const result& res);
+
+	/*!
+	@brief 获取底层句柄
+	*/
+	int native();
+
+	/*!
+	@brief 关闭socket
+	*/
+	result close();
+
+	/*!
+	@brief 取消所有等待中的异步操作，等待中的读写返回operation_aborted
+	*/
+	result cancel();
+
+	/*!
+	@brief 是否已打开
+	*/
+	bool is_open();
+
+	/*!
+	@brief 非阻塞尝试发送数据，同时通过SCM_RIGHTS传递fdCount个文件描述符(不超过UNIX_SCM_MAX_FDS)，
+	流式socket传递描述符时length不能为0(内核不发送空数据，描述符会被丢弃)，否则返回invalid_argument
+	*/
+	result try_send_fds(const void* buff, size_t length, const int* fds, size_t fdCount);
+
+	/*!
+	@brief 非阻塞尝试接收数据及随附的文件描述符
+	@param fdCount 输入fds容量，返回接收到的描述符个数，超出容量的描述符被内核丢弃
+	*/
+	result try_recv_fds(void* buff, size_t length, int* fds, size_t& fdCount);
+
+	/*!
+	@brief 发送数据并传递文件描述符，流式socket部分发送时剩余数据不再携带描述符
+	*/
+	result send_fds(my_actor* host, const void* buff, size_t length, const int* fds, size_t fdCount);
+
+	/*!
+	@brief 接收数据及随附的文件描述符
+	*/
+	result recv_fds(my_actor* host, void* buff, size_t length, int* fds, size_t& fdCount);
+
+	/*!
+	@brief 在ms时间范围内，接收数据及随附的文件描述符
+	*/
+	result timed_recv_fds(my_actor* host, int ms, void* buff, size_t length, int* fds, size_t& fdCount);
+protected:
+	template <typename Handler>
+	bool async_io(bool write, char* buff, size_t currBytes, size_t length, bool all, Handler&& handler)
+	{
+		typedef RM_CREF(Handler) handler_type;
+		result res = { currBytes, 0, false };
+		while (true)
+		{
+			result tr = write ? try_send_same(buff + res.s, length - res.s, NULL) : try_recv_same(buff + res.s, length - res.s, NULL);
+			if (tr.ok)
+			{
+				res.s += tr.s;
+				if (!all || res.s == length)
+				{
+					res.ok = true;
+					break;
+				}
+				continue;
+			}
+			if (try_again(tr))
+			{
+				try
+				{
+					auto h = std::bind([this, write, buff, length, all](handler_type& handler, size_t currBytes, const boost::system::error_code& ec, size_t)
+					{
+						if (ec)
+						{
+							handler(result{ currBytes, ec.value(), false });
+						}
+						else
+						{
+							async_io(write, buff, currBytes, length, all, std::move(handler));
+						}
+					}, std::forward<Handler>(handler), res.s, __1, __2);
+					if (write)
+					{
+						_socket.async_send(boost::asio::null_buffers(), std::move(h));
+					}
+					else
+					{
+						_socket.async_receive(boost::asio::null_buffers(), std::move(h));
+					}
+					return false;
+				}
+				catch (const boost::system::system_error& se)
+				{
+					tr.code = se.code().value();
+				}
+			}
+			res.code = tr.code;
+			break;
+		}
+		handler(res);
+		return true;
+	}
+
+	result do_io(my_actor* host, long long deadline, bool write, char* buff, size_t length, bool all, endpoint* remoteEndpoint);
+	result try_send_same(const void* buff, size_t length, const endpoint* remoteEndpoint);
+	result try_recv_same(void* buff, size_t length, endpoint* remoteEndpoint);
+	result try_msend_same(const endpoint* remoteEndpoints, size_t endpointStep, const void* const* buffs, const size_t* lengths, size_t count, size_t* bytes);
+	result try_mrecv_same(endpoint* remoteEndpoints, void* const* buffs, const size_t* lengths, size_t count, size_t* bytes);
+	result wait_ready(my_actor* host, long long deadline, bool write);
+	void timeout_cancel();
+protected:
+	typename Protocol::socket _socket;
+	std::atomic<unsigned> _cancelCount;//cancel()调用计数，用于区分超时取消波及的另一方向操作
+	NONE_COPY(UnixSocket_);
+};
+
+/*!
+@brief unix域流式通信，本机进程间通信不经过tcp/ip协议栈
+*/
+class unix_socket : public UnixSocket_<boost::asio::local::stream_protocol>
+{
+	friend unix_acceptor;
+public:
+	unix_socket(io_engine& ios);
+	~unix_socket();
+public:
+	/*!
+	@brief 创建一对相互连接的socket
+	*/
+	static result pair(unix_socket& a, unix_socket& b);
+
+	/*!
+	@brief 连接path上监听的服务端
+	*/
+	result connect(my_actor* host, const char* path);
+	result connect(my_actor* host, const endpoint& remoteEndpoint);
+
+	/*!
+	@brief 在ms时间范围内，连接服务端
+	*/
+	result timed_connect(my_actor* host, int ms, const char* path);
+	result timed_connect(my_actor* host, int ms, const endpoint& remoteEndpoint);
+
+	/*!
+	@brief 往缓冲区内读取数据，有多少读多少
+	*/
+	result read_some(my_actor* host, void* buff, size_t length);
+
+	/*!
+	@brief 往缓冲区内读取数据，直到读满
+	*/
+	result read(my_actor* host, void* buff, size_t length);
+
+	/*!
+	@brief 将数据发送出去，能发多少是多少
+	*/
+	result write_some(my_actor* host, const void* buff, size_t length);
+
+	/*!
+	@brief 将数据全部发送出去
+	*/
+	result write(my_actor* host, const void* buff, size_t length);
+
+	/*!
+	@brief 在ms时间范围内，往缓冲区内读取数据，有多少读多少
+	*/
+	result timed_read_some(my_actor* host, int ms, void* buff, size_t length);
+
+	/*!
+	@brief 在ms时间范围内，往缓冲区内读取数据，直到读满
+	*/
+	result timed_read(my_actor* host, int ms, void* buff, size_t length);
+
+	/*!
+	@brief 在ms时间范围内，将数据全部发送出去
+	*/
+	result timed_write(my_actor* host, int ms, const void* buff, size_t length);
+
+	/*!
+	@brief 非阻塞尝试读取数据
+	*/
+	result try_read_same(void* buff, size_t length);
+
+	/*!
+	@brief 非阻塞尝试写入数据
+	*/
+	result try_write_same(const void* buff, size_t length);
+
+	/*!
+	@brief 异步模式下，连接服务端
+	*/
+	template <typename Handler>
+	void async_connect(const endpoint& remoteEndpoint, Handler&& handler)
+	{
+		typedef RM_CREF(Handler) handler_type;
+		_socket.async_connect(remoteEndpoint, std::bind([](handler_type& handler, const boost::system::error_code& ec)
+		{
+			handler(result{ 0, ec.value(), !ec });
+		}, std::forward<Handler>(handler), __1));
+	}
+
+	/*!
+	@brief 异步模式下，往缓冲区内读取数据，有多少读多少；
+	先尝试非阻塞读取，返回true表示已在本函数内完成回调
+	*/
+	template <typename Handler>
+	bool async_read_some(void* buff, size_t length, Handler&& handler)
+	{
+		return async_io(false, (char*)buff, 0, length, false, std::forward<Handler>(handler));
+	}
+
+	/*!
+	@brief 异步模式下，往缓冲区内读取数据，直到读满
+	*/
+	template <typename Handler>
+	bool async_read(void* buff, size_t length, Handler&& handler)
+	{
+		return async_io(false, (char*)buff, 0, length, true, std::forward<Handler>(handler));
+	}
+
+	/*!
+	@brief 异步模式下，将数据发送出去，能发多少是多少
+	*/
+	template <typename Handler>
+	bool async_write_some(const void* buff, size_t length, Handler&& handler)
+	{
+		return async_io(true, (char*)buff, 0, length, false, std::forward<Handler>(handler));
+	}
+
+	/*!
+	@brief 异步模式下，将数据全部发送出去
+	*/
+	template <typename Handler>
+	bool async_write(const void* buff, size_t length, Handler&& handler)
+	{
+		return async_io(true, (char*)buff, 0, length, true, std::forward<Handler>(handler));
+	}
+private:
+	result connect(my_actor* host, int ms, const endpoint& remoteEndpoint);
+};
+
+/*!
+@brief unix域流式监听器
+*/
+class unix_acceptor
+{
+public:
+	typedef socket_result result;
+public:
+	unix_acceptor(io_engine& ios);
+	~unix_acceptor();
+public:
+	/*!
+	@brief 在path上监听，以'@'开头时使用linux抽象命名空间
+	@param removeOld 先删除残留的socket文件
+	*/
+	result open(const char* path, bool removeOld = true);
+
+	/*!
+	@brief 关闭监听，并删除open时创建的socket文件
+	*/
+	result close();
+
+	/*!
+	@brief 是否已打开
+	*/
+	bool is_open();
+
+	/*!
+	@brief 非阻塞尝试接受一个连接
+	*/
+	result try_accept(unix_socket& socket);
+
+	/*!
+	@brief 接受一个连接
+	*/
+	result accept(my_actor* host, unix_socket& socket);
+
+	/*!
+	@brief 在ms时间范围内，接受一个连接
+	*/
+	result timed_accept(my_actor* host, int ms, unix_socket& socket);
+
+	/*!
+	@brief 异步模式下，接受一个连接；先尝试非阻塞接受，返回true表示已在本函数内完成回调
+	*/
+	template <typename Handler>
+	bool async_accept(unix_socket& socket, Handler&& handler)
+	{
+		typedef RM_CREF(Handler) handler_type;
+		result res = try_accept(socket);
+		if (!res.ok && unix_socket::try_again(res))
+		{
+			try
+			{
+				_acceptor.async_accept(socket._socket, std::bind([](handler_type& handler, const boost::system::error_code& ec)
+				{
+					handler(result{ 0, ec.value(), !ec });
+				}, std::forward<Handler>(handler), __1));
+				return false;
+			}
+			catch (const boost::system::system_error& se)
+			{
+				res.code = se.code().value();
+			}
+		}
+		handler(res);
+		return true;
+	}
+private:
+	boost::asio::local::stream_protocol::acceptor _acceptor;
+	std::string _path;
+	NONE_COPY(unix_acceptor);
+};
+
+/*!
+@brief unix域数据报通信，保留消息边界，本机内不丢包
+*/
+class unix_dgram_socket : public UnixSocket_<boost::asio::local::datagram_protocol>
+{
+public:
+	unix_dgram_socket(io_engine& ios);
+	~unix_dgram_socket();
+public:
+	/*!
+	@brief 创建一对相互连接的socket
+	*/
+	static result pair(unix_dgram_socket& a, unix_dgram_socket& b);
+
+	/*!
+	@brief 打开一个未绑定地址的socket
+	*/
+	result open();
+
+	/*!
+	@brief 打开并绑定到path，以'@'开头时使用linux抽象命名空间
+	@param removeOld 先删除残留的socket文件
+	*/
+	result open_bind(const char* path, bool removeOld = true);
+
+	/*!
+	@brief 设置默认发送目标
+	*/
+	result connect(const char* path);
+	result connect(const endpoint& remoteEndpoint);
+
+	/*!
+	@brief 发送一个数据报
+	*/
+	result send(my_actor* host, const void* buff, size_t length);
+	result send_to(my_actor* host, const endpoint& remoteEndpoint, const void* buff, size_t length);
+
+	/*!
+	@brief 接收一个数据报
+	*/
+	result receive(my_actor* host, void* buff, size_t length);
+	result receive_from(my_actor* host, endpoint& remoteEndpoint, void* buff, size_t length);
+
+	/*!
+	@brief 在ms时间范围内，接收一个数据报
+	*/
+	result timed_receive(my_actor* host, int ms, void* buff, size_t length);
+	result timed_receive_from(my_actor* host, int ms, endpoint& remoteEndpoint, void* buff, size_t length);
+
+	/*!
+	@brief 非阻塞尝试发送/接收一个数据报
+	*/
+	result try_send(const void* buff, size_t length);
+	result try_send_to(const endpoint& remoteEndpoint, const void* buff, size_t length);
+	result try_receive(void* buff, size_t length);
+	result try_receive_from(endpoint& remoteEndpoint, void* buff, size_t length);
+
+	/*!
+	@brief 非阻塞尝试一次发送多个数据报(ENABLE_SCK_MULTI_IO下使用sendmmsg)
+	@param bytes 不为NULL时返回每个数据报发送的字节数
+	@return 发送的数据报个数
+	*/
+	result try_msend(const void* const* buffs, const size_t* lengths, size_t count, size_t* bytes = NULL);
+	result try_msend_to(const endpoint& remoteEndpoint, const void* const* buffs, const size_t* lengths, size_t count, size_t* bytes = NULL);
+	result try_msend_to(const endpoint* remoteEndpoints, const void* const* buffs, const size_t* lengths, size_t count, size_t* bytes = NULL);
+
+	/*!
+	@brief 非阻塞尝试一次接收多个数据报(ENABLE_SCK_MULTI_IO下使用recvmmsg)
+	@param bytes 不为NULL时返回每个数据报接收的字节数
+	@return 接收的数据报个数
+	*/
+	result try_mreceive(void* const* buffs, const size_t* lengths, size_t count, size_t* bytes = NULL);
+	result try_mreceive_from(endpoint* remoteEndpoints, void* const* buffs, const size_t* lengths, size_t count, size_t* bytes = NULL);
+
+	/*!
+	@brief 异步模式下，发送一个数据报；先尝试非阻塞发送，返回true表示已在本函数内完成回调
+	*/
+	template <typename Handler>
+	bool async_send(const void* buff, size_t length, Handler&& handler)
+	{
+		return async_io(true, (char*)buff, 0, length, false, std::forward<Handler>(handler));
+	}
+
+	/*!
+	@brief 异步模式下，接收一个数据报；先尝试非阻塞接收，返回true表示已在本函数内完成回调
+	*/
+	template <typename Handler>
+	bool async_receive(void* buff, size_t length, Handler&& handler)
+	{
+		return async_io(false, (char*)buff, 0, length, false, std::forward<Handler>(handler));
+	}
+private:
+	std::string _path;
+};
+
+#endif
+#endif
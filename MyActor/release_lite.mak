@@ -0,0 +1,33 @@
+#Generated by VisualGDB (http://visualgdb.com)
+#DO NOT EDIT THIS FILE MANUALLY UNLESS YOU ABSOLUTELY NEED TO
+#USE VISUALGDB PROJECT PROPERTIES DIALOG INSTEAD
+
+BINARYDIR := ReleaseLite
+
+#Toolchain
+CC := /usr/gcc-4.9.3/bin/gcc
+CXX := /usr/gcc-4.9.3/bin/g++
+LD := $(CXX)
+AR := ar
+OBJCOPY := objcopy
+
+#Additional flags
+PREPROCESSOR_MACROS := NDEBUG RELEASE ENABLE_NEXT_TICK ENABLE_CHECK_LOST ENABLE_LITE_CHECK_LOST DISABLE_BOOST_TIMER ENABLE_DUMP_STACK
+INCLUDE_DIRS := /home/ham/cpplib/boost
+LIBRARY_DIRS := /home/ham/cpplib/boost/stage/lib ./actor/lib
+LIBRARY_NAMES := pthread rt dl fcontext_x64 boost_thread boost_system boost_chrono
+ADDITIONAL_LINKER_INPUTS := 
+MACOS_FRAMEWORKS := 
+LINUX_PACKAGES := 
+
+CFLAGS := -ffunction-sections -O2
+CXXFLAGS := -ffunction-sections -O2 -fno-rtti -std=c++11 -Wall -Wno-reorder -Wno-unused-but-set-variable -Wno-unused-variable -Wno-delete-non-virtual-dtor -Wno-strict-aliasing
+ASFLAGS := 
+LDFLAGS := -Wl,-gc-sections
+COMMONFLAGS := 
+
+START_GROUP := -Wl,--start-group
+END_GROUP := -Wl,--end-group
+
+#Additional options detected from testing the toolchain
+IS_LINUX_PROJECT := 1